@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+#include "green/h5pp/archive.h"
+
+/**
+ * Benchmark of small-dataset read throughput with and without HDF5 page buffer.
+ *
+ * usage: small_datasets_bench [number of datasets] [dataset size] [directory]
+ */
+
+using namespace green::h5pp;
+
+namespace {
+  void write_file(const std::string& filename, size_t n_datasets, size_t size, const creation_options& creation) {
+    archive             ar(filename, "w", {}, creation);
+    std::vector<double> data(size);
+    for (size_t i = 0; i < n_datasets; ++i) {
+      data.assign(size, double(i));
+      ar["GROUP_" + std::to_string(i % 64) + "/DATA_" + std::to_string(i)] << data;
+    }
+  }
+
+  double read_file(const std::string& filename, size_t n_datasets, const access_options& options) {
+    auto                start = std::chrono::steady_clock::now();
+    archive             ar(filename, "r", options);
+    std::vector<double> data;
+    double              checksum = 0;
+    for (size_t i = 0; i < n_datasets; ++i) {
+      ar["GROUP_" + std::to_string(i % 64) + "/DATA_" + std::to_string(i)] >> data;
+      checksum += data[0];
+    }
+    ar.close();
+    auto end = std::chrono::steady_clock::now();
+    if (checksum < 0) std::cout << checksum << std::endl;
+    return std::chrono::duration<double>(end - start).count();
+  }
+
+  void report(const std::string& name, size_t n_datasets, size_t size, double time) {
+    std::cout << name << ": " << time << " s, " << n_datasets / time << " datasets/s, "
+              << n_datasets * size * sizeof(double) / time / (1 << 20) << " MiB/s" << std::endl;
+  }
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t      n_datasets   = argc > 1 ? std::stoul(argv[1]) : 10000;
+  size_t      size         = argc > 2 ? std::stoul(argv[2]) : 16;
+  std::string directory    = argc > 3 ? argv[3] : std::filesystem::temp_directory_path().string();
+  std::string default_file = directory + "/h5pp_bench_default.h5";
+  std::string paged_file   = directory + "/h5pp_bench_paged.h5";
+
+  creation_options paged;
+  paged.fspace_strategy = H5F_FSPACE_STRATEGY_PAGE;
+  paged.page_size       = 64 << 10;
+  write_file(default_file, n_datasets, size, {});
+  write_file(paged_file, n_datasets, size, paged);
+
+  access_options page_buffer;
+  page_buffer.page_buffer_size = 16 << 20;
+  std::cout << "Reading " << n_datasets << " datasets of " << size << " elements" << std::endl;
+  report("default layout             ", n_datasets, size, read_file(default_file, n_datasets, {}));
+  report("paged layout               ", n_datasets, size, read_file(paged_file, n_datasets, {}));
+  report("paged layout + page buffer ", n_datasets, size, read_file(paged_file, n_datasets, page_buffer));
+
+  std::filesystem::remove(default_file);
+  std::filesystem::remove(paged_file);
+  return 0;
+}
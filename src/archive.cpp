@@ -8,24 +8,200 @@
 #include <filesystem>
 #include <iostream>
 
-green::h5pp::archive::archive(const std::string& filename, const std::string& access_type) :
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+namespace {
+  /**
+   * Name of the member file `index' of a file family. Family name is used by HDF5 as a printf format, so it is checked to
+   * contain exactly one integer conversion (`%d', `%i' or `%u' with optional flags and width) and no other conversions
+   * except `%%'. Member name is then built without passing the user-supplied name to printf.
+   */
+  std::string family_member_filename(const std::string& filename, unsigned index) {
+    std::string name;
+    size_t      conversions = 0;
+    for (size_t i = 0; i < filename.size(); ++i) {
+      if (filename[i] != '%') {
+        name += filename[i];
+        continue;
+      }
+      if (i + 1 < filename.size() && filename[i + 1] == '%') {
+        name += '%';
+        ++i;
+        continue;
+      }
+      size_t end = filename.find_first_not_of("-+ #0123456789", i + 1);
+      if (end == std::string::npos || std::string("diu").find(filename[end]) == std::string::npos || ++conversions > 1) {
+        throw green::h5pp::hdf5_file_access_error("Family file name '" + filename +
+                                                  "' should contain exactly one integer pattern, e.g. `%d', and `%%' for '%'");
+      }
+      // specification consists only of checked flags and width, so it is safe to use it as a format
+      std::string spec = filename.substr(i, end - i + 1);
+      char        member[64];
+      std::snprintf(member, sizeof(member), spec.c_str(), index);
+      name += member;
+      i     = end;
+    }
+    if (conversions != 1) {
+      throw green::h5pp::hdf5_file_access_error("Family file name '" + filename +
+                                                "' should contain exactly one integer pattern, e.g. `%d', and `%%' for '%'");
+    }
+    return name;
+  }
+
+  /**
+   * Name of the file on disk that indicates existence of the archive. For family driver this is the first member file,
+   * for split driver this is the metadata file.
+   */
+  std::string storage_filename(const std::string& filename, const green::h5pp::access_options& options) {
+    if (options.driver == green::h5pp::FAMILY_DRIVER) {
+      return family_member_filename(filename, 0);
+    }
+    if (options.driver == green::h5pp::SPLIT_DRIVER) {
+      const auto& ext = options.split_meta_ext;
+      size_t      pos = ext.find("%s");
+      return pos == std::string::npos ? filename + ext : ext.substr(0, pos) + filename + ext.substr(pos + 2);
+    }
+    return filename;
+  }
+
+  hid_t create_access_plist(const std::string& filename, const std::string& access_type,
+                            const green::h5pp::access_options& options) {
+    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+    if (options.swmr && access_type != "r") {
+      // SWMR write requires the latest file format
+      H5Pset_libver_bounds(fapl, H5F_LIBVER_LATEST, H5F_LIBVER_LATEST);
+    }
+    herr_t status = 0;
+    if (options.driver == green::h5pp::FAMILY_DRIVER) {
+      status = H5Pset_fapl_family(fapl, options.family_member_size, H5P_DEFAULT);
+    } else if (options.driver == green::h5pp::SPLIT_DRIVER) {
+      status = H5Pset_fapl_split(fapl, options.split_meta_ext.c_str(), H5P_DEFAULT, options.split_raw_ext.c_str(), H5P_DEFAULT);
+    }
+    if (status < 0) {
+      H5Pclose(fapl);
+      throw green::h5pp::hdf5_file_access_error("Can not set file driver for hdf5 file '" + filename + "'");
+    }
+    if (options.page_buffer_size != 0 && H5Pset_page_buffer_size(fapl, options.page_buffer_size, 0, 0) < 0) {
+      H5Pclose(fapl);
+      throw green::h5pp::hdf5_file_access_error("Can not set page buffer size for hdf5 file '" + filename + "'");
+    }
+    return fapl;
+  }
+
+  hid_t create_creation_plist(const std::string& filename, const green::h5pp::creation_options& creation) {
+    hid_t  fcpl   = H5Pcreate(H5P_FILE_CREATE);
+    herr_t status = H5Pset_file_space_strategy(fcpl, creation.fspace_strategy, creation.persist_free_space,
+                                               creation.free_space_threshold);
+    if (status >= 0 && creation.page_size != 0) {
+      status = H5Pset_file_space_page_size(fcpl, creation.page_size);
+    }
+    if (status < 0) {
+      H5Pclose(fcpl);
+      throw green::h5pp::hdf5_file_access_error("Can not set file space options for hdf5 file '" + filename + "'");
+    }
+    return fcpl;
+  }
+
+  /**
+   * Copy attribute `name' of object `src' to object `dst'. Data is read with the type of the attribute in file,
+   * this way any attribute type can be copied.
+   */
+  herr_t copy_attribute(hid_t src, const char* name, const H5A_info_t*, void* op_data) {
+    hid_t             dst      = *static_cast<hid_t*>(op_data);
+    hid_t             attr     = H5Aopen(src, name, H5P_DEFAULT);
+    hid_t             type_id  = H5Aget_type(attr);
+    hid_t             space_id = H5Aget_space(attr);
+    std::vector<char> buffer(H5Sget_simple_extent_npoints(space_id) * H5Tget_size(type_id));
+    herr_t            status   = H5Aread(attr, type_id, buffer.data());
+    hid_t             new_attr = H5Acreate2(dst, name, type_id, space_id, H5P_DEFAULT, H5P_DEFAULT);
+    if (status >= 0 && new_attr != H5I_INVALID_HID) status = H5Awrite(new_attr, type_id, buffer.data());
+    if (new_attr == H5I_INVALID_HID) status = -1;
+    if (H5Tdetect_class(type_id, H5T_VLEN) > 0 || H5Tis_variable_str(type_id) > 0) {
+      H5Dvlen_reclaim(type_id, space_id, H5P_DEFAULT, buffer.data());
+    }
+    if (new_attr != H5I_INVALID_HID) H5Aclose(new_attr);
+    H5Sclose(space_id);
+    H5Tclose(type_id);
+    H5Aclose(attr);
+    return status;
+  }
+
+  /**
+   * Copy file `from' into `to'. On file systems that support reflinks (e.g. Btrfs, XFS) the copy shares all data blocks
+   * with the original and takes constant time, otherwise the whole file is copied.
+   */
+  void clone_file(const std::string& from, const std::string& to, std::error_code& ec) {
+#if defined(__linux__) && defined(FICLONE)
+    int src = ::open(from.c_str(), O_RDONLY);
+    if (src >= 0) {
+      struct stat src_stat;
+      int         dst    = fstat(src, &src_stat) == 0 ? ::open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, src_stat.st_mode) : -1;
+      bool        cloned = dst >= 0 && ioctl(dst, FICLONE, src) == 0;
+      if (dst >= 0) ::close(dst);
+      ::close(src);
+      if (cloned) return;
+    }
+#endif
+    std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing, ec);
+  }
+
+  /**
+   * Flush content of file or directory `path' from the operating system cache to the storage device.
+   *
+   * @return `false' if data could not be flushed
+   */
+  bool sync_file(const std::string& path) {
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool synced = fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+#else
+    return true;
+#endif
+  }
+
+  /**
+   * Collect names of all links in a group
+   */
+  herr_t collect_link(hid_t, const char* name, const H5L_info_t*, void* op_data) {
+    static_cast<std::vector<std::string>*>(op_data)->emplace_back(name);
+    return 0;
+  }
+}  // namespace
+
+green::h5pp::archive::archive(const std::string& filename, const std::string& access_type, const access_options& options,
+                              const creation_options& creation) :
     object(H5I_INVALID_HID, "/", FILE, access_type == "r"), _filename(filename) {
-  open(filename, access_type);
+  open(filename, access_type, options, creation);
 }
 
-void green::h5pp::archive::open(const std::string& filename, const std::string& access_type) {
+void green::h5pp::archive::open(const std::string& filename, const std::string& access_type, const access_options& options,
+                                const creation_options& creation) {
   if (file_id() != H5I_INVALID_HID) {
     throw hdf5_file_access_error("File is already opened. Please close current file before opening another.");
   }
   if (access_type != "r" && access_type != "w" && access_type != "a") {
     throw hdf5_unknown_access_type_error("Unknown access type '" + access_type + "'. Should be 'r', 'w' or 'a'");
   }
-  bool file_exists = std::filesystem::exists(filename);
+  bool file_exists = std::filesystem::exists(storage_filename(filename, options));
 
   if (access_type == "r") {
     if (!file_exists) {
       throw hdf5_file_access_error("File '" + filename + "' does not exist.");
     }
+  }
+  // H5Fis_hdf5 can only check files written with the default driver
+  if (access_type == "r" && options.driver == DEFAULT_DRIVER) {
     htri_t info = H5Fis_hdf5(filename.c_str());
     if (info < 0) {
       throw hdf5_file_access_error("Error accessing hdf5 file '" + filename + "'.");
@@ -34,31 +210,205 @@ void green::h5pp::archive::open(const std::string& filename, const std::string&
       throw not_hdf5_file_error("'" + filename + "' is not an HDF5 file.");
     }
   }
-  hid_t file = H5I_INVALID_HID;
+  hid_t    fapl       = create_access_plist(filename, access_type, options);
+  hid_t    fcpl       = create_creation_plist(filename, creation);
+  unsigned read_flags = options.swmr ? H5F_ACC_RDONLY | H5F_ACC_SWMR_READ : H5F_ACC_RDONLY;
+  hid_t    file       = H5I_INVALID_HID;
   if (access_type == "r")
-    file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    file = H5Fopen(filename.c_str(), read_flags, fapl);
   else if (access_type == "a")
-    file = file_exists ? H5Fopen(filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT)
-                       : H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    file = file_exists ? H5Fopen(filename.c_str(), H5F_ACC_RDWR, fapl) : H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, fcpl, fapl);
   else if (access_type == "w")
-    file = H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    file = H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, fcpl, fapl);
+  H5Pclose(fcpl);
+  H5Pclose(fapl);
   if (file == H5I_INVALID_HID) {
     throw hdf5_file_access_error("Can not open hdf5 file '" + filename + "'");
   }
-  file_id()    = file;
-  current_id() = file;
-  readonly()   = access_type == "r";
+  file_id()         = file;
+  current_id()      = file;
+  readonly()        = access_type == "r";
+  _filename         = filename;
+  _access_options   = options;
+  _creation_options = creation;
+  handle_cache()    = options.handle_cache_capacity > 0 && !options.swmr
+                          ? std::make_shared<internal::handle_cache>(options.handle_cache_capacity)
+                          : nullptr;
 }
 
 green::h5pp::archive::~archive() {
   if (file_id() != H5I_INVALID_HID) close();
 }
 
+void green::h5pp::archive::flush() {
+  if (H5Fflush(file_id(), H5F_SCOPE_GLOBAL) < 0) {
+    throw hdf5_file_access_error("Can not flush file '" + _filename + "'");
+  }
+}
+
+void green::h5pp::archive::start_swmr_write() {
+  if (readonly()) {
+    throw hdf5_write_error("Can not start SWMR write for readonly file '" + _filename + "'");
+  }
+  if (H5Fstart_swmr_write(file_id()) < 0) {
+    throw hdf5_file_access_error("Can not start SWMR write for file '" + _filename + "'. File should be open with `swmr' option.");
+  }
+}
+
+void green::h5pp::archive::compact() {
+  if (readonly()) {
+    throw hdf5_write_error("Can not compact readonly file '" + _filename + "'");
+  }
+  if (_access_options.driver != DEFAULT_DRIVER) {
+    throw hdf5_notsupported_error("Compaction is only supported for default file driver.");
+  }
+  // compacted shadow file would be reopened as a regular archive and the checkpoint target would be lost
+  if (in_checkpoint()) {
+    throw hdf5_write_error("Can not compact file '" + _filename + "' during checkpoint");
+  }
+  std::string tmp_filename = _filename + ".compact";
+  std::string tmp_root     = "/.h5pp_compact";
+  hid_t       fapl         = create_access_plist(tmp_filename, "w", _access_options);
+  // creation properties are taken from the file itself, since archive could have been opened without them
+  hid_t       fcpl         = H5Fget_create_plist(file_id());
+  hid_t       tmp_file     = fcpl == H5I_INVALID_HID ? H5I_INVALID_HID : H5Fcreate(tmp_filename.c_str(), H5F_ACC_TRUNC, fcpl, fapl);
+  H5Pclose(fcpl);
+  H5Pclose(fapl);
+  if (tmp_file == H5I_INVALID_HID) {
+    throw hdf5_file_access_error("Can not create temporary file '" + tmp_filename + "'");
+  }
+  // Copy the whole tree in a single call, so that objects with multiple hard links stay shared,
+  // and then move it under the new root group
+  std::vector<std::string> names;
+  herr_t                   status = -1;
+  try {
+    copy_object(file_id(), "/", tmp_file, tmp_root);
+    hid_t tmp_group = H5Gopen2(tmp_file, tmp_root.c_str(), H5P_DEFAULT);
+    status          = H5Literate(tmp_group, H5_INDEX_NAME, H5_ITER_NATIVE, NULL, collect_link, &names);
+    for (size_t i = 0; i < names.size() && status >= 0; ++i) {
+      status = H5Lmove(tmp_group, names[i].c_str(), tmp_file, names[i].c_str(), H5P_DEFAULT, H5P_DEFAULT);
+    }
+    hid_t tmp_file_root = H5Gopen2(tmp_file, "/", H5P_DEFAULT);
+    if (status >= 0) status = H5Aiterate2(tmp_group, H5_INDEX_NAME, H5_ITER_NATIVE, NULL, copy_attribute, &tmp_file_root);
+    H5Gclose(tmp_file_root);
+    H5Gclose(tmp_group);
+    if (status >= 0) status = H5Ldelete(tmp_file, tmp_root.c_str(), H5P_DEFAULT);
+  } catch (const hdf5_copy_object_error&) {
+    status = -1;
+  }
+  H5Fclose(tmp_file);
+  if (status < 0) {
+    std::filesystem::remove(tmp_filename);
+    throw hdf5_write_error("Can not compact file '" + _filename + "'");
+  }
+  std::string      filename = _filename;
+  access_options   options  = _access_options;
+  creation_options creation = _creation_options;
+  close();
+  std::error_code ec;
+  std::filesystem::rename(tmp_filename, filename, ec);
+  if (ec) {
+    std::filesystem::remove(tmp_filename, ec);
+    open(filename, "a", options, creation);
+    throw hdf5_file_access_error("Can not replace '" + filename + "' with compacted file");
+  }
+  open(filename, "a", options, creation);
+}
+
+void green::h5pp::archive::begin_checkpoint() {
+  if (readonly()) {
+    throw hdf5_write_error("Can not checkpoint readonly file '" + _filename + "'");
+  }
+  if (_access_options.driver != DEFAULT_DRIVER) {
+    throw hdf5_notsupported_error("Checkpoint is only supported for default file driver.");
+  }
+  if (in_checkpoint()) {
+    throw hdf5_write_error("Checkpoint of file '" + _filename + "' is already in progress");
+  }
+  // file is closed with weak close degree, objects that are still open would keep it open and the copy would miss their
+  // unflushed metadata
+  if (handle_cache()) handle_cache()->clear();
+  if (H5Fget_obj_count(file_id(), H5F_OBJ_ALL | H5F_OBJ_LOCAL) > 1) {
+    throw hdf5_write_error("Can not checkpoint file '" + _filename + "' while objects obtained from it are still open");
+  }
+  if (H5Fflush(file_id(), H5F_SCOPE_GLOBAL) < 0) {
+    throw hdf5_write_error("Can not flush file '" + _filename + "'");
+  }
+  std::string      filename = _filename;
+  std::string      shadow   = _filename + ".checkpoint";
+  access_options   options  = _access_options;
+  creation_options creation = _creation_options;
+  close();
+  std::error_code ec;
+  clone_file(filename, shadow, ec);
+  if (ec) {
+    open(filename, "a", options, creation);
+    throw hdf5_file_access_error("Can not create shadow file '" + shadow + "': " + ec.message());
+  }
+  try {
+    open(shadow, "a", options, creation);
+  } catch (...) {
+    std::filesystem::remove(shadow, ec);
+    open(filename, "a", options, creation);
+    throw;
+  }
+  _checkpoint_target   = filename;
+  _checkpoint_tracking = get_change_tracking();
+  set_change_tracking(true);
+}
+
+void green::h5pp::archive::commit_checkpoint() {
+  if (!in_checkpoint()) {
+    throw hdf5_write_error("No checkpoint in progress for file '" + _filename + "'");
+  }
+  std::string      shadow   = _filename;
+  std::string      filename = _checkpoint_target;
+  access_options   options  = _access_options;
+  creation_options creation = _creation_options;
+  _checkpoint_target.clear();
+  close();
+  // shadow file should be on disk before it replaces the original, otherwise a crash could leave a truncated file
+  std::error_code ec;
+  if (!sync_file(shadow)) ec = std::make_error_code(std::errc::io_error);
+  // rename within the same directory atomically replaces the original file
+  if (!ec) std::filesystem::rename(shadow, filename, ec);
+  if (ec) {
+    // keep checkpoint in progress, so that it can be committed again or aborted
+    open(shadow, "a", options, creation);
+    _checkpoint_target = filename;
+    throw hdf5_file_access_error("Can not replace '" + filename + "' with checkpoint: " + ec.message());
+  }
+  // make the rename itself durable
+  sync_file(std::filesystem::absolute(filename).parent_path().string());
+  open(filename, "a", options, creation);
+  set_change_tracking(_checkpoint_tracking);
+}
+
+void green::h5pp::archive::abort_checkpoint() {
+  if (!in_checkpoint()) {
+    throw hdf5_write_error("No checkpoint in progress for file '" + _filename + "'");
+  }
+  access_options   options  = _access_options;
+  creation_options creation = _creation_options;
+  close();
+  open(_filename, "a", options, creation);
+}
+
 bool green::h5pp::archive::close() {
+  // cached datasets would keep the file open
+  if (handle_cache()) handle_cache()->clear();
   if (H5Fclose(file_id()) < 0) {
     throw hdf5_file_access_error("Can not close file '" + _filename + "'");
   }
   file_id()    = H5I_INVALID_HID;
   current_id() = H5I_INVALID_HID;
+  // uncommitted checkpoint is discarded
+  if (in_checkpoint()) {
+    std::error_code ec;
+    std::filesystem::remove(_filename, ec);
+    _filename = _checkpoint_target;
+    _checkpoint_target.clear();
+    set_change_tracking(_checkpoint_tracking);
+  }
   return true;
 }
\ No newline at end of file
@@ -5,13 +5,77 @@
 
 #include "green/h5pp/common.h"
 
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+  /**
+   * Process-wide table of interned paths. Children are indexed by the address of the interned parent path, which stays
+   * valid since interned paths are never released.
+   */
+  struct path_table {
+    using path_ptr = std::shared_ptr<const std::string>;
+    std::mutex                                                                          mutex;
+    std::unordered_map<std::string, path_ptr>                                           paths;
+    std::unordered_map<const std::string*, std::unordered_map<std::string, path_ptr>> children;
+  };
+
+  path_table& interned_paths() {
+    static path_table table;
+    return table;
+  }
+}  // namespace
+
+uint64_t green::h5pp::internal::hash_bytes(const void* data, size_t size, uint64_t seed) {
+  // four independent multiply-rotate lanes over 8-byte words, combined and finalized with murmur3 mixer
+  constexpr uint64_t prime1   = 0x9E3779B185EBCA87ull;
+  constexpr uint64_t prime2   = 0xC2B2AE3D27D4EB4Full;
+  auto               rotl     = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+  auto               round    = [&](uint64_t acc, uint64_t word) { return rotl(acc + word * prime2, 31) * prime1; };
+  const char*        bytes    = static_cast<const char*>(data);
+  uint64_t           lanes[4] = {seed + prime1 + prime2, seed + prime2, seed, seed - prime1};
+  size_t             i        = 0;
+  for (; i + 32 <= size; i += 32) {
+    for (int k = 0; k < 4; ++k) {
+      uint64_t word;
+      std::memcpy(&word, bytes + i + 8 * k, sizeof(word));
+      lanes[k] = round(lanes[k], word);
+    }
+  }
+  uint64_t hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18) + size;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    hash = rotl(hash ^ round(0, word), 27) * prime1 + prime2;
+  }
+  for (; i < size; ++i) hash = rotl(hash ^ (uint64_t(uint8_t(bytes[i])) * prime1), 11) * prime2;
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDull;
+  hash ^= hash >> 33;
+  hash *= 0xC4CEB9FE1A85EC53ull;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+uint64_t green::h5pp::internal::hash_type(hid_t type_id, uint64_t seed) {
+  size_t size = 0;
+  if (H5Tencode(type_id, NULL, &size) < 0) {
+    throw hdf5_data_conversion_error("Can not encode type description");
+  }
+  std::vector<unsigned char> buffer(size);
+  if (H5Tencode(type_id, buffer.data(), &size) < 0) {
+    throw hdf5_data_conversion_error("Can not encode type description");
+  }
+  return hash_bytes(buffer.data(), size, seed);
+}
+
 hid_t green::h5pp::create_group(hid_t root_parent, const std::string& name) {
-  std::vector<std::string> parents_list = utils::split(name, "/");
-  std::string              current_root;
-  hid_t                    g_id = H5I_INVALID_HID;
-  for (const auto& parent : parents_list) {
-    current_root += "/" + parent;
-    htri_t check = H5Lexists(root_parent, current_root.c_str(), H5P_DEFAULT);
+  thread_local utils::path_builder current_root;
+  hid_t                            g_id = H5I_INVALID_HID;
+  current_root.clear();
+  utils::for_each_token(name, '/', [&](std::string_view parent) {
+    htri_t check = H5Lexists(root_parent, current_root.append(parent).c_str(), H5P_DEFAULT);
     if (check <= 0) {
       g_id = H5Gcreate2(root_parent, current_root.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
       if (g_id == H5I_INVALID_HID) {
@@ -19,7 +83,7 @@ hid_t green::h5pp::create_group(hid_t root_parent, const std::string& name) {
       }
       H5Gclose(g_id);
     }
-  }
+  });
   g_id = H5Gopen2(root_parent, current_root.c_str(), H5P_DEFAULT);
   if (g_id == H5I_INVALID_HID) {
     throw hdf5_create_group_error("Can not create group " + name);
@@ -33,3 +97,45 @@ void green::h5pp::move_group(hid_t src_loc_id, const std::string& src_name, hid_
     throw hdf5_move_group_error("Can not move group " + src_name + " to " + dst_name);
   }
 }
+
+void green::h5pp::copy_object(hid_t src_loc_id, const std::string& src_name, hid_t dst_loc_id, const std::string& dst_name,
+                              const copy_options& options) {
+  unsigned flags = 0;
+  if (options.shallow) flags |= H5O_COPY_SHALLOW_HIERARCHY_FLAG;
+  if (options.expand_soft_links) flags |= H5O_COPY_EXPAND_SOFT_LINK_FLAG;
+  if (options.expand_external_links) flags |= H5O_COPY_EXPAND_EXT_LINK_FLAG;
+  if (!options.preserve_attributes) flags |= H5O_COPY_WITHOUT_ATTR_FLAG;
+  hid_t ocpypl = H5Pcreate(H5P_OBJECT_COPY);
+  hid_t lcpl   = H5Pcreate(H5P_LINK_CREATE);
+  H5Pset_copy_object(ocpypl, flags);
+  H5Pset_create_intermediate_group(lcpl, 1);
+  herr_t herr = H5Ocopy(src_loc_id, src_name.c_str(), dst_loc_id, dst_name.c_str(), ocpypl, lcpl);
+  H5Pclose(lcpl);
+  H5Pclose(ocpypl);
+  if (herr < 0) {
+    throw hdf5_copy_object_error("Can not copy " + src_name + " to " + dst_name);
+  }
+}
+
+std::shared_ptr<const std::string> green::h5pp::intern_path(const std::string& path) {
+  auto&                       table = interned_paths();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  auto                        it = table.paths.find(path);
+  if (it == table.paths.end()) it = table.paths.emplace(path, std::make_shared<const std::string>(path)).first;
+  return it->second;
+}
+
+std::shared_ptr<const std::string> green::h5pp::intern_path(const std::shared_ptr<const std::string>& parent,
+                                                            const std::string&                        name) {
+  auto&                       table = interned_paths();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  // children are indexed by the interned copy of the parent, so that its address can not be reused
+  auto                        root = table.paths.find(*parent);
+  if (root == table.paths.end()) root = table.paths.emplace(*parent, parent).first;
+  auto& children = table.children[root->second.get()];
+  auto  it       = children.find(name);
+  if (it == children.end()) {
+    it = children.emplace(name, std::make_shared<const std::string>(utils::join_path(*parent, name))).first;
+  }
+  return it->second;
+}
@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#include "green/h5pp/compression.h"
+
+#include <zlib.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <thread>
+
+namespace {
+
+  /**
+   * Byte shuffle as implemented by HDF5 shuffle filter: j-th byte of i-th element goes to position j * n + i
+   */
+  void shuffle_bytes(const char* src, char* dst, size_t n, size_t element_size) {
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t j = 0; j < element_size; ++j) {
+        dst[j * n + i] = src[i * element_size + j];
+      }
+    }
+  }
+
+  void unshuffle_bytes(const char* src, char* dst, size_t n, size_t element_size) {
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t j = 0; j < element_size; ++j) {
+        dst[i * element_size + j] = src[j * n + i];
+      }
+    }
+  }
+
+  size_t number_of_threads(size_t threads, size_t chunks) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    return std::max<size_t>(1, std::min(threads, chunks));
+  }
+
+  /**
+   * Chunk being processed by the pipeline
+   */
+  struct chunk_buffer {
+    std::vector<char> data;
+    bool              ready = false;
+    bool              error = false;
+  };
+
+  /**
+   * Ordered pipeline between the HDF5 thread and a pool of workers. Workers take chunk indices in increasing order and
+   * at most `window' chunks can be in flight, so memory usage is bounded independently of the dataset size.
+   */
+  class chunk_pipeline {
+  public:
+    chunk_pipeline(size_t chunks, size_t window) : _chunks(chunks), _window(window), _next(0), _first(0) {}
+
+    /**
+     * Take next chunk index, blocks while the window is full
+     * @return chunk index or `npos' if there is no more work
+     */
+    size_t take() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition.wait(lock, [this] { return _next >= _chunks || _next < _first + _window || _stop; });
+      if (_next >= _chunks || _stop) return npos;
+      return _next++;
+    }
+
+    void release(size_t first) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _first = first;
+      }
+      _condition.notify_all();
+    }
+
+    void stop() {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+      }
+      _condition.notify_all();
+    }
+
+    static constexpr size_t npos = size_t(-1);
+
+  private:
+    size_t                  _chunks;
+    size_t                  _window;
+    size_t                  _next;
+    size_t                  _first;
+    bool                    _stop = false;
+    std::mutex              _mutex;
+    std::condition_variable _condition;
+  };
+
+  /**
+   * Fill `row' with a single record of dataset `d_id' filled with the fill value of the dataset
+   *
+   * @return `false' if fill value can not be obtained
+   */
+  bool dataset_fill_row(hid_t d_id, const green::h5pp::internal::chunk_layout& layout, std::vector<char>& row) {
+    hid_t             dcpl    = H5Dget_create_plist(d_id);
+    hid_t             type_id = H5Dget_type(d_id);
+    std::vector<char> value(layout.element_size, 0);
+    H5D_fill_value_t  status;
+    bool              success = dcpl != H5I_INVALID_HID && type_id != H5I_INVALID_HID && H5Pfill_value_defined(dcpl, &status) >= 0;
+    // undefined fill value leaves the content unspecified, zeros are used as for default fill value
+    if (success && status == H5D_FILL_VALUE_USER_DEFINED) success = H5Pget_fill_value(dcpl, type_id, value.data()) >= 0;
+    if (type_id != H5I_INVALID_HID) H5Tclose(type_id);
+    if (dcpl != H5I_INVALID_HID) H5Pclose(dcpl);
+    row.resize(layout.row_bytes);
+    for (size_t i = 0; i < row.size(); i += layout.element_size) std::memcpy(row.data() + i, value.data(), layout.element_size);
+    return success;
+  }
+
+}  // namespace
+
+void green::h5pp::internal::write_chunks(hid_t d_id, const std::string& path, const char* data, const chunk_layout& layout,
+                                         const compression_options& options) {
+  size_t chunks      = (layout.rows + layout.chunk_rows - 1) / layout.chunk_rows;
+  size_t chunk_bytes = layout.chunk_rows * layout.row_bytes;
+  size_t threads     = number_of_threads(options.threads, chunks);
+  size_t window      = 2 * threads;
+  if (chunks == 0) return;
+  std::vector<chunk_buffer> buffers(window);
+  std::mutex                mutex;
+  std::condition_variable   done;
+  chunk_pipeline            pipeline(chunks, window);
+  auto                      worker = [&]() {
+    std::vector<char> raw;
+    std::vector<char> shuffled;
+    for (size_t k = pipeline.take(); k != chunk_pipeline::npos; k = pipeline.take()) {
+      std::vector<char> compressed;
+      bool              error;
+      // exception can not leave the worker thread, allocation failure is reported as a failed chunk
+      try {
+        raw.resize(chunk_bytes);
+        if (options.shuffle) shuffled.resize(chunk_bytes);
+        // edge chunk is padded with zeros up to the full chunk size, as HDF5 does
+        size_t rows  = std::min(layout.chunk_rows, layout.rows - k * layout.chunk_rows);
+        size_t bytes = rows * layout.row_bytes;
+        std::memcpy(raw.data(), data + k * chunk_bytes, bytes);
+        std::memset(raw.data() + bytes, 0, chunk_bytes - bytes);
+        const char* src = raw.data();
+        if (options.shuffle) {
+          shuffle_bytes(raw.data(), shuffled.data(), chunk_bytes / layout.element_size, layout.element_size);
+          src = shuffled.data();
+        }
+        uLongf compressed_size = compressBound(chunk_bytes);
+        compressed.resize(compressed_size);
+        error = compress2(reinterpret_cast<Bytef*>(compressed.data()), &compressed_size, reinterpret_cast<const Bytef*>(src),
+                          chunk_bytes, options.level) != Z_OK;
+        compressed.resize(compressed_size);
+      } catch (const std::bad_alloc&) {
+        error = true;
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffers[k % window].data  = std::move(compressed);
+        buffers[k % window].error = error;
+        buffers[k % window].ready = true;
+      }
+      done.notify_all();
+    }
+  };
+  std::vector<std::thread> pool;
+  for (size_t i = 0; i < threads; ++i) pool.emplace_back(worker);
+  std::vector<hsize_t> offset(layout.rank, 0);
+  bool                 failed = false;
+  for (size_t k = 0; k < chunks && !failed; ++k) {
+    chunk_buffer chunk;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      done.wait(lock, [&] { return buffers[k % window].ready; });
+      std::swap(chunk, buffers[k % window]);
+    }
+    pipeline.release(k + 1);
+    offset[0] = k * layout.chunk_rows;
+    failed    = chunk.error ||
+             H5Dwrite_chunk(d_id, H5P_DEFAULT, 0, offset.data(), chunk.data.size(), chunk.data.data()) < 0;
+  }
+  pipeline.stop();
+  for (auto& thread : pool) thread.join();
+  if (failed) {
+    throw hdf5_write_error("Can not write compressed chunks into " + path);
+  }
+}
+
+void green::h5pp::internal::read_chunks(hid_t d_id, const std::string& path, char* data, const chunk_layout& layout, bool shuffle,
+                                        size_t threads) {
+  size_t chunks      = (layout.rows + layout.chunk_rows - 1) / layout.chunk_rows;
+  size_t chunk_bytes = layout.chunk_rows * layout.row_bytes;
+  if (chunks == 0) return;
+  threads = number_of_threads(threads, chunks);
+  std::deque<std::pair<size_t, std::vector<char>>> queue;
+  std::mutex                                       mutex;
+  std::condition_variable                          ready;
+  std::condition_variable                          space;
+  size_t                                           window   = 2 * threads;
+  bool                                             finished = false;
+  std::atomic<bool>                                error    = false;
+  auto                                             worker   = [&]() {
+    std::vector<char> raw;
+    std::vector<char> unshuffled;
+    while (true) {
+      std::pair<size_t, std::vector<char>> chunk;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [&] { return finished || !queue.empty(); });
+        if (queue.empty()) return;
+        chunk = std::move(queue.front());
+        queue.pop_front();
+      }
+      space.notify_one();
+      auto& [k, compressed] = chunk;
+      // exception can not leave the worker thread, allocation failure is reported through the error flag and remaining
+      // chunks are still taken from the queue, so that the reading thread is not blocked
+      try {
+        raw.resize(chunk_bytes);
+        if (shuffle) unshuffled.resize(chunk_bytes);
+      } catch (const std::bad_alloc&) {
+        error = true;
+        continue;
+      }
+      uLongf raw_size       = chunk_bytes;
+      if (uncompress(reinterpret_cast<Bytef*>(raw.data()), &raw_size, reinterpret_cast<const Bytef*>(compressed.data()),
+                     compressed.size()) != Z_OK ||
+          raw_size != chunk_bytes) {
+        error = true;
+        continue;
+      }
+      const char* src = raw.data();
+      if (shuffle) {
+        unshuffle_bytes(raw.data(), unshuffled.data(), chunk_bytes / layout.element_size, layout.element_size);
+        src = unshuffled.data();
+      }
+      // only valid part of the edge chunk is copied
+      size_t rows = std::min(layout.chunk_rows, layout.rows - k * layout.chunk_rows);
+      std::memcpy(data + k * chunk_bytes, src, rows * layout.row_bytes);
+    }
+  };
+  // single record filled with the fill value of the dataset, created on the first unallocated chunk
+  std::vector<char>        fill_row;
+  std::vector<std::thread> pool;
+  for (size_t i = 0; i < threads; ++i) pool.emplace_back(worker);
+  std::vector<hsize_t> offset(layout.rank, 0);
+  // workers should be joined before an exception of the reading thread, e.g. failed allocation, leaves the function
+  std::exception_ptr exception;
+  try {
+    for (size_t k = 0; k < chunks && !error; ++k) {
+      offset[0]          = k * layout.chunk_rows;
+      size_t rows        = std::min(layout.chunk_rows, layout.rows - k * layout.chunk_rows);
+      hsize_t chunk_size = 0;
+      if (H5Dget_chunk_storage_size(d_id, offset.data(), &chunk_size) < 0 || chunk_size == 0) {
+        // chunk has not been allocated, it contains fill value
+        if (fill_row.empty() && !dataset_fill_row(d_id, layout, fill_row)) {
+          error = true;
+          break;
+        }
+        for (size_t r = 0; r < rows; ++r) {
+          std::memcpy(data + k * chunk_bytes + r * layout.row_bytes, fill_row.data(), layout.row_bytes);
+        }
+        continue;
+      }
+      std::vector<char> compressed(chunk_size);
+      uint32_t          filter_mask = 0;
+      if (H5Dread_chunk(d_id, H5P_DEFAULT, offset.data(), &filter_mask, compressed.data()) < 0 || filter_mask != 0) {
+        error = true;
+        break;
+      }
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        space.wait(lock, [&] { return queue.size() < window; });
+        queue.emplace_back(k, std::move(compressed));
+      }
+      ready.notify_one();
+    }
+  } catch (...) {
+    exception = std::current_exception();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    finished = true;
+  }
+  ready.notify_all();
+  for (auto& thread : pool) thread.join();
+  if (exception) std::rethrow_exception(exception);
+  if (error) {
+    throw hdf5_read_error("Can not read compressed chunks from " + path);
+  }
+}
+
+bool green::h5pp::internal::direct_chunk_layout(hid_t d_id, hid_t mem_type_id, chunk_layout& layout, bool& shuffle) {
+  hid_t dcpl = H5Dget_create_plist(d_id);
+  if (dcpl == H5I_INVALID_HID) return false;
+  bool result = H5Pget_layout(dcpl) == H5D_CHUNKED;
+  // filter pipeline should be [shuffle] deflate
+  int  nfilters = result ? H5Pget_nfilters(dcpl) : 0;
+  result        = result && (nfilters == 1 || nfilters == 2);
+  shuffle       = false;
+  for (int i = 0; result && i < nfilters; ++i) {
+    unsigned     flags;
+    size_t       cd_nelmts = 0;
+    unsigned     filter_config;
+    H5Z_filter_t filter = H5Pget_filter2(dcpl, i, &flags, &cd_nelmts, NULL, 0, NULL, &filter_config);
+    if (i == 0 && nfilters == 2) {
+      shuffle = filter == H5Z_FILTER_SHUFFLE;
+      result  = shuffle;
+    } else {
+      result = filter == H5Z_FILTER_DEFLATE;
+    }
+  }
+  auto                 dims = dataset_dims(d_id);
+  int                  rank = dims.size();
+  std::vector<hsize_t> chunk(std::max(rank, 1));
+  result = result && rank > 0 && H5Pget_chunk(dcpl, rank, chunk.data()) == rank;
+  H5Pclose(dcpl);
+  // chunks should span all trailing dimensions
+  for (int i = 1; result && i < rank; ++i) result = chunk[i] == dims[i];
+  if (!result) return false;
+  hid_t file_type_id = H5Dget_type(d_id);
+  result             = H5Tequal(file_type_id, mem_type_id) > 0;
+  size_t elem_size   = H5Tget_size(file_type_id);
+  H5Tclose(file_type_id);
+  if (!result) return false;
+  size_t row_size = std::accumulate(dims.begin() + 1, dims.end(), 1ul, std::multiplies<>());
+  layout          = chunk_layout{dims[0], row_size * elem_size, size_t(chunk[0]), elem_size, size_t(rank)};
+  return layout.chunk_rows > 0;
+}
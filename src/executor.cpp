@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#include "green/h5pp/executor.h"
+
+green::h5pp::io_executor::io_executor(const std::string& filename, const std::string& access_type,
+                                      const access_options& options) :
+    _archive(filename, access_type, options), _stop(false) {
+  _thread = std::thread(&io_executor::run, this);
+}
+
+green::h5pp::io_executor::~io_executor() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _condition.notify_one();
+  _thread.join();
+}
+
+void green::h5pp::io_executor::wait() { submit([](archive&) {}).wait(); }
+
+void green::h5pp::io_executor::enqueue(std::function<void()>&& request) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _queue.push_back(std::move(request));
+  }
+  _condition.notify_one();
+}
+
+void green::h5pp::io_executor::run() {
+  std::vector<std::function<void()>> batch;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition.wait(lock, [this] { return _stop || !_queue.empty(); });
+      if (_queue.empty()) return;
+      // take all pending requests at once
+      batch.swap(_queue);
+    }
+    for (auto& request : batch) request();
+    batch.clear();
+  }
+}
@@ -10,10 +10,85 @@
 
 namespace green::h5pp {
 
+  /**
+   * Low-level file drivers that can be used to store the archive
+   */
+  enum file_driver {
+    // single file
+    DEFAULT_DRIVER,
+    // archive is split into a sequence of member files of a fixed size
+    FAMILY_DRIVER,
+    // metadata and raw data are stored in two separate files
+    SPLIT_DRIVER
+  };
+
+  /**
+   * Additional file access options for archive
+   */
+  struct access_options {
+    /**
+     * Single-writer/multiple-reader mode. For read-only files the file is open with SWMR read flag and datasets are refreshed
+     * before each read. For writable files the latest file format is used, so that SWMR write can be started with
+     * `archive::start_swmr_write' once all datasets are created.
+     */
+    bool        swmr                  = false;
+    /**
+     * File driver to be used. For family driver the file name should contain exactly one printf-style integer pattern for
+     * the member index, e.g. `data-%d.h5' or `data-%03d.h5', literal `%' should be written as `%%'.
+     */
+    file_driver driver                = DEFAULT_DRIVER;
+    /**
+     * Size of a single member file in bytes for family driver
+     */
+    hsize_t     family_member_size    = 1ul << 30;
+    /**
+     * Extensions of metadata and raw data files for split driver. Extension can contain `%s' that is replaced by the file name,
+     * this way metadata and raw data can be placed in different directories, e.g. "/local/scratch/%s-m.h5".
+     */
+    std::string split_meta_ext        = "-m.h5";
+    std::string split_raw_ext         = "-r.h5";
+    /**
+     * Size of HDF5 page buffer in bytes, 0 disables page buffering. Page buffer can only be used for files created with
+     * paged aggregation (`H5F_FSPACE_STRATEGY_PAGE' strategy in creation options) and should be at least one file space page.
+     * Small metadata and raw data reads are then served from the cached pages instead of separate I/O requests.
+     */
+    size_t      page_buffer_size      = 0;
+    /**
+     * Number of dataset handles kept open by archive, 0 disables the cache. Cached datasets are found by path without any
+     * HDF5 calls on subscript, their shape and type are kept between reads. Least recently used handles are closed when the
+     * capacity is exceeded, handles are dropped when links are moved or removed and when the archive is closed. Cache is not
+     * used in SWMR mode since datasets should be refreshed before each read.
+     */
+    size_t      handle_cache_capacity = 0;
+  };
+
+  /**
+   * File creation options for archive. Options are used only when new file is created and are stored in the file.
+   */
+  struct creation_options {
+    /**
+     * File space handling strategy, see H5Pset_file_space_strategy
+     */
+    H5F_fspace_strategy_t fspace_strategy      = H5F_FSPACE_STRATEGY_FSM_AGGR;
+    /**
+     * Keep track of free space across file opens, so that space released by unlinked or recreated datasets can be reused later
+     */
+    bool                  persist_free_space   = false;
+    /**
+     * Smallest size of free space section to be tracked
+     */
+    hsize_t               free_space_threshold = 1;
+    /**
+     * File space page size for paged aggregation strategy, 0 stands for HDF5 default
+     */
+    hsize_t               page_size            = 0;
+  };
+
   class archive : public object {
   public:
     archive() : object(H5I_INVALID_HID, H5I_INVALID_HID, "", FILE, false) {};
-    archive(const std::string& filename, const std::string& access_type = "r");
+    archive(const std::string& filename, const std::string& access_type = "r", const access_options& options = {},
+            const creation_options& creation = {});
     virtual ~archive();
 
     /**
@@ -28,11 +103,69 @@ namespace green::h5pp {
      *
      * @param filename
      * @param access_type
+     * @param options - additional file access options
+     * @param creation - file creation options, used if new file is created
+     */
+    void open(const std::string& filename, const std::string& access_type = "r", const access_options& options = {},
+              const creation_options& creation = {});
+
+    /**
+     * Flush all buffers associated with the file to disk. In SWMR mode this makes appended data visible to readers.
+     */
+    void flush();
+
+    /**
+     * Switch file into single-writer/multiple-reader write mode. File should be open for write with `swmr' access option.
+     * All groups and datasets should be created before this call, after it existing datasets should only be updated or extended.
+     */
+    void start_swmr_write();
+
+    /**
+     * Rewrite archive densely into a new file and replace current file with it. All objects, attributes and links
+     * are preserved, space of unlinked or recreated datasets is released. New file has the same creation properties, e.g.
+     * file space strategy and page size, as the current one. Archive is reopened afterwards, objects that were obtained from
+     * archive before compaction become invalid. If the file can not be replaced, the original file is reopened. Only supported
+     * for writable files with default file driver.
+     */
+    void compact();
+
+    /**
+     * Start incremental checkpoint. Current file is copied into a shadow file next to it and the archive is reopened on the
+     * shadow copy with change tracking enabled, so only datasets whose content differs from the stored one are rewritten.
+     * The original file is not modified until `commit_checkpoint', so a crash during the checkpoint leaves the last committed
+     * state intact. Objects obtained from archive should be destroyed before the call, otherwise checkpoint is refused. Only
+     * supported for writable files with default file driver. Archive can not be compacted during checkpoint.
+     *
+     * On file systems with reflink support (e.g. Btrfs, XFS) the shadow copy shares data blocks with the original and is
+     * created in constant time. Otherwise the whole file, including data that will not change, is copied on every call, so
+     * for large files with mostly static data the checkpoint costs at least one full read and write of the file.
+     */
+    void begin_checkpoint();
+
+    /**
+     * Flush the shadow file to the storage device, atomically replace the original file with it by rename and reopen the
+     * archive on it.
+     */
+    void commit_checkpoint();
+
+    /**
+     * Discard all changes made since `begin_checkpoint' and reopen the original file.
+     */
+    void abort_checkpoint();
+
+    /**
+     * @return `true' if checkpoint is in progress
      */
-    void open(const std::string& filename, const std::string& access_type = "r");
+    bool in_checkpoint() const { return !_checkpoint_target.empty(); }
 
   private:
-    std::string _filename;
+    std::string      _filename;
+    access_options   _access_options;
+    creation_options _creation_options;
+    // path of the file that will be replaced by the shadow file on commit, empty outside of checkpoint
+    std::string      _checkpoint_target;
+    // change tracking state before checkpoint
+    bool             _checkpoint_tracking = false;
   };
 
 }  // namespace green::h5pp
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#ifndef H5PP_ARRAY_VIEW_H
+#define H5PP_ARRAY_VIEW_H
+
+#include <functional>
+#include <numeric>
+#include <vector>
+
+namespace green::h5pp {
+
+  /**
+   * Non-owning view of a contiguous multidimensional array in row-major order.
+   *
+   * @tparam T - type of array elements
+   */
+  template <typename T>
+  class array_view {
+  public:
+    array_view() : _data(nullptr), _size(0) {}
+    array_view(T* data, const std::vector<size_t>& shape) :
+        _data(data), _shape(shape), _size(std::accumulate(shape.begin(), shape.end(), 1ul, std::multiplies<>())) {}
+
+    T*                         data() const { return _data; }
+    size_t                     size() const { return _size; }
+    const std::vector<size_t>& shape() const { return _shape; }
+
+    T&                         operator[](size_t i) const { return _data[i]; }
+    T*                         begin() const { return _data; }
+    T*                         end() const { return _data + _size; }
+
+  private:
+    T*                  _data;
+    std::vector<size_t> _shape;
+    size_t              _size;
+  };
+
+}  // namespace green::h5pp
+
+#endif  // H5PP_ARRAY_VIEW_H
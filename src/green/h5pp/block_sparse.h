@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#ifndef H5PP_BLOCK_SPARSE_H
+#define H5PP_BLOCK_SPARSE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "array_view.h"
+#include "buffer.h"
+#include "sparse.h"
+
+namespace green::h5pp {
+
+  /**
+   * Block-sparse tensor, a set of dense blocks of arbitrary shapes identified by integer keys, e.g. blocks of symmetry-adapted
+   * quantities labeled by irreducible representation and spin. All blocks are packed into a single contiguous array of values
+   * in the order they were added.
+   *
+   * Stored as a group with `h5pp_format' attribute set to "block_sparse", packed `values' dataset and `index' dataset. Row `i'
+   * of the `index' table describes block `i' as (key, offset in values, rank, dim_0, ..., dim_{rank-1}), rows are padded with
+   * zeros up to the largest rank.
+   *
+   * @tparam T - type of values
+   */
+  template <typename T>
+  class block_sparse_tensor {
+  public:
+    using value_type = T;
+
+    /**
+     * Description of a single block
+     */
+    struct block_info {
+      int64_t             key;
+      size_t              offset;
+      std::vector<size_t> shape;
+
+      size_t              size() const { return internal::shape_size(shape); }
+    };
+
+    /**
+     * Add new block and allocate space for it in the packed array. Views of the previously added blocks are invalidated.
+     *
+     * @param key - key of the block
+     * @param shape - shape of the block
+     * @return view of the new block, initialized with zeros
+     */
+    array_view<T> add_block(int64_t key, const std::vector<size_t>& shape) {
+      if (_lookup.count(key) != 0) {
+        throw hdf5_write_error("Block " + std::to_string(key) + " already exists");
+      }
+      block_info info{key, _values.size(), shape};
+      _values.resize(_values.size() + info.size());
+      _lookup.emplace(key, _blocks.size());
+      _blocks.push_back(std::move(info));
+      return block(key);
+    }
+
+    /**
+     * @param key - key of the block
+     * @return view of the block with key `key'
+     */
+    array_view<T> block(int64_t key) {
+      const block_info& info = find(key);
+      return array_view<T>(_values.data() + info.offset, info.shape);
+    }
+    array_view<const T> block(int64_t key) const {
+      const block_info& info = find(key);
+      return array_view<const T>(_values.data() + info.offset, info.shape);
+    }
+
+    bool                           has_block(int64_t key) const { return _lookup.count(key) != 0; }
+    const std::vector<block_info>& blocks() const { return _blocks; }
+    const std::vector<T>&          values() const { return _values; }
+    void                           reserve(size_t size) { _values.reserve(size); }
+
+    void                           clear() {
+      _blocks.clear();
+      _lookup.clear();
+      _values.clear();
+    }
+
+    /**
+     * Replace content of the tensor by deserialized blocks, used by reader.
+     */
+    void assign(std::vector<block_info>&& blocks, std::vector<T>&& values) {
+      clear();
+      _blocks = std::move(blocks);
+      _values = std::move(values);
+      for (size_t i = 0; i < _blocks.size(); ++i) _lookup.emplace(_blocks[i].key, i);
+    }
+
+  private:
+    std::vector<block_info>             _blocks;
+    std::unordered_map<int64_t, size_t> _lookup;
+    std::vector<T>                      _values;
+
+    const block_info&                   find(int64_t key) const {
+      auto it = _lookup.find(key);
+      if (it == _lookup.end()) {
+        throw hdf5_read_error("Block " + std::to_string(key) + " does not exist");
+      }
+      return _blocks[it->second];
+    }
+  };
+
+  template <typename T>
+  struct is_block_sparse_t : std::false_type {};
+  template <typename T>
+  struct is_block_sparse_t<block_sparse_tensor<T>> : std::true_type {};
+  template <typename T>
+  constexpr bool is_block_sparse = is_block_sparse_t<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+
+  namespace internal {
+    // number of leading columns of the block index table: key, offset and rank
+    constexpr size_t block_index_header = 3;
+
+    /**
+     * Read block index table of the block-sparse tensor stored in group `group_id'
+     */
+    template <typename T>
+    std::vector<typename block_sparse_tensor<T>::block_info> read_block_index(hid_t group_id, const std::string& path) {
+      if (sparse_format(group_id) != "block_sparse") {
+        throw hdf5_read_error(path + " does not contain block-sparse tensor");
+      }
+      ndbuffer<int64_t> index;
+      read_sparse_member(group_id, path, "index", index);
+      if (index.shape().size() != 2 || index.shape()[1] < block_index_header) {
+        throw hdf5_read_error("Block index of " + path + " is malformed");
+      }
+      size_t                                                   width = index.shape()[1];
+      std::vector<typename block_sparse_tensor<T>::block_info> blocks(index.shape()[0]);
+      for (size_t i = 0; i < blocks.size(); ++i) {
+        const int64_t* row  = index.data() + i * width;
+        size_t         rank = size_t(row[2]);
+        if (rank > width - block_index_header) {
+          throw hdf5_read_error("Block index of " + path + " is malformed");
+        }
+        blocks[i].key    = row[0];
+        blocks[i].offset = size_t(row[1]);
+        blocks[i].shape.assign(row + block_index_header, row + block_index_header + rank);
+      }
+      return blocks;
+    }
+  }  // namespace internal
+
+  /**
+   * Create group `name' and store all blocks of block-sparse tensor `rhs' in it. All parent groups will be created if needed.
+   *
+   * @tparam T - type of block-sparse tensor
+   * @param root_parent - id of the parent group
+   * @param name - path of the group
+   * @param rhs - block-sparse tensor to be written
+   * @return id of the created group
+   */
+  template <typename T>
+  std::enable_if_t<is_block_sparse<T>, hid_t> write_sparse(hid_t root_parent, const std::string& name, const T& rhs) {
+    size_t max_rank = 0;
+    for (const auto& b : rhs.blocks()) max_rank = std::max(max_rank, b.shape.size());
+    size_t               width = internal::block_index_header + max_rank;
+    std::vector<int64_t> index(rhs.blocks().size() * width, 0);
+    for (size_t i = 0; i < rhs.blocks().size(); ++i) {
+      const auto& b    = rhs.blocks()[i];
+      int64_t*    row  = index.data() + i * width;
+      row[0]           = b.key;
+      row[1]           = int64_t(b.offset);
+      row[2]           = int64_t(b.shape.size());
+      std::copy(b.shape.begin(), b.shape.end(), row + internal::block_index_header);
+    }
+    hid_t group_id = create_group(root_parent, name);
+    write_attribute(group_id, "h5pp_format", std::string("block_sparse"));
+    internal::write_sparse_member(group_id, "index", array_view<const int64_t>(index.data(), {rhs.blocks().size(), width}));
+    internal::write_sparse_member(group_id, "values", rhs.values());
+    return group_id;
+  }
+
+  /**
+   * Read all blocks of block-sparse tensor from group `group_id'.
+   *
+   * @tparam T - type of block-sparse tensor
+   * @param group_id - id of the group
+   * @param path - absolute path to the group (needed for error message)
+   * @param rhs - target block-sparse tensor
+   */
+  template <typename T>
+  std::enable_if_t<is_block_sparse<T>> read_sparse(hid_t group_id, const std::string& path, T& rhs) {
+    using value_type = typename std::remove_reference_t<T>::value_type;
+    auto                    blocks = internal::read_block_index<value_type>(group_id, path);
+    std::vector<value_type> values;
+    internal::read_sparse_member(group_id, path, "values", values);
+    for (const auto& b : blocks) {
+      if (b.offset + b.size() > values.size()) {
+        throw hdf5_read_error("Block " + std::to_string(b.key) + " is out of bounds of " + path);
+      }
+    }
+    rhs.assign(std::move(blocks), std::move(values));
+  }
+
+  /**
+   * Read a single block with key `key' of block-sparse tensor stored in group `group_id'. Only the block index and the values
+   * of the requested block are read.
+   *
+   * @tparam T - type of the target array
+   * @param group_id - id of the group
+   * @param path - absolute path to the group (needed for error message)
+   * @param key - key of the block
+   * @param rhs - target array, resized to the block shape if possible
+   */
+  template <typename T>
+  void read_sparse_block(hid_t group_id, const std::string& path, int64_t key, T& rhs) {
+    static_assert(is_1D_array<T> || is_ND_array<T>, "Block can only be read into an array");
+    using value_type = std::remove_cv_t<std::remove_reference_t<decltype(*rhs.data())>>;
+    auto blocks      = internal::read_block_index<value_type>(group_id, path);
+    auto it          = std::find_if(blocks.begin(), blocks.end(), [key](const auto& b) { return b.key == key; });
+    if (it == blocks.end()) {
+      throw hdf5_read_error("Block " + std::to_string(key) + " does not exist in " + path);
+    }
+    size_t size = it->size();
+    if constexpr (is_resizable_nd<T>) {
+      rhs.resize(it->shape);
+    } else if constexpr (is_resizable<T>) {
+      rhs.resize(size);
+    }
+    if (size_t(rhs.size()) != size) {
+      throw hdf5_read_error("Size of block " + std::to_string(key) + " in " + path + " does not match size of the target array");
+    }
+    if (size == 0) return;
+    hid_t d_id = H5Dopen2(group_id, "values", H5P_DEFAULT);
+    if (d_id == H5I_INVALID_HID) {
+      throw hdf5_read_error("Block-sparse tensor " + path + " does not have values dataset");
+    }
+    try {
+      read_hyperslab(d_id, path + "/values", {it->offset}, {size}, rhs.data());
+    } catch (...) {
+      H5Dclose(d_id);
+      throw;
+    }
+    H5Dclose(d_id);
+  }
+
+}  // namespace green::h5pp
+
+#endif  // H5PP_BLOCK_SPARSE_H
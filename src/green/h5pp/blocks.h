@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#ifndef H5PP_BLOCKS_H
+#define H5PP_BLOCKS_H
+
+#include <iterator>
+#include <vector>
+
+#include "array_view.h"
+#include "common.h"
+
+namespace green::h5pp {
+
+  namespace internal {
+    // default memory budget for a single block of streaming reads
+    inline constexpr size_t default_block_bytes = 16ul << 20;
+
+    /**
+     * Choose shape of blocks that are read at once. Blocks span as many slabs along axis `axis' as fit into the budget. If
+     * a single slab exceeds the budget, blocks hold one slab and the slab is further split along the remaining axes in
+     * row-major order, so that a block never exceeds the budget unless a single element does. For chunked datasets the
+     * extent along the split axis is aligned to chunk boundaries whenever at least one chunk fits, so that every chunk is
+     * read and decompressed only once.
+     *
+     * @param d_id - dataset id
+     * @param dims - shape of the dataset
+     * @param axis - axis to split the dataset along
+     * @param element_size - size of a single element in memory
+     * @param budget - memory budget in bytes
+     * @return shape of a block, the last blocks along every axis can be smaller
+     */
+    inline std::vector<size_t> aligned_block_shape(hid_t d_id, const shape_buffer<hsize_t>& dims, size_t axis,
+                                                   size_t element_size, size_t budget) {
+      size_t              rank = dims.size();
+      std::vector<size_t> shape(dims.begin(), dims.end());
+      if (rank == 0) return shape;
+      // axes are split in order: the iterated axis first, then the remaining axes in row-major order
+      std::vector<size_t> order{axis};
+      for (size_t i = 0; i < rank; ++i) {
+        if (i != axis) order.push_back(i);
+      }
+      // find the outermost axis whose single slab fits into the budget, outer axes are reduced to a single index
+      size_t level = 0;
+      size_t slab  = element_size;
+      for (; level < rank; ++level) {
+        slab = element_size;
+        for (size_t j = level + 1; j < rank; ++j) slab *= dims[order[j]];
+        if (slab <= budget || level + 1 == rank) break;
+        shape[order[level]] = 1;
+      }
+      size_t split  = order[level];
+      size_t extent = std::max<size_t>(1, budget / std::max<size_t>(1, slab));
+      hid_t  dcpl   = H5Dget_create_plist(d_id);
+      if (H5Pget_layout(dcpl) == H5D_CHUNKED) {
+        shape_buffer<hsize_t> chunk(rank);
+        if (H5Pget_chunk(dcpl, int(rank), chunk.data()) == int(rank) && chunk[split] > 0 && chunk[split] <= extent) {
+          extent = extent / chunk[split] * chunk[split];
+        }
+      }
+      H5Pclose(dcpl);
+      shape[split] = std::max<size_t>(1, std::min<size_t>(extent, dims[split]));
+      return shape;
+    }
+  }  // namespace internal
+
+  /**
+   * Block of a dataset returned by `block_range'
+   *
+   * @tparam T - type of elements in memory
+   */
+  template <typename T>
+  struct dataset_block {
+    // position of the first slab of the block along the iterated axis
+    size_t              offset = 0;
+    // position of the first element of the block in all dimensions, differs from `offset' only along the split axes
+    std::vector<size_t> origin;
+    // data of the block, shape of the dataset with the extents of the iterated and split axes replaced by the extents of
+    // the block
+    array_view<const T> view;
+  };
+
+  /**
+   * Single-pass range of consecutive blocks of a dataset along a chosen axis. Blocks are read one at a time into a buffer
+   * that is reused for all blocks, so memory usage is bounded by the block size regardless of the dataset size. Slabs that
+   * do not fit into the budget are read in parts, see `internal::aligned_block_shape'. Blocks along the leading axis are
+   * consecutive parts of the dataset in row-major order. View of the current block is invalidated when the iterator is
+   * advanced. Range keeps the dataset open, so it can outlive the object it was obtained from.
+   *
+   *     for (const auto& block : ar["data"].blocks<double>()) process(block.offset, block.view);
+   *
+   * @tparam T - type of elements in memory
+   */
+  template <typename T>
+  class block_range {
+  public:
+    class iterator {
+    public:
+      using iterator_category = std::input_iterator_tag;
+      using value_type        = dataset_block<T>;
+      using difference_type   = std::ptrdiff_t;
+      using pointer           = const value_type*;
+      using reference         = const value_type&;
+
+      iterator() : _range(nullptr) {}
+
+      reference operator*() const { return _range->_block; }
+      pointer   operator->() const { return &_range->_block; }
+      iterator& operator++() {
+        if (!_range->read_next()) _range = nullptr;
+        return *this;
+      }
+      bool operator==(const iterator& rhs) const { return _range == rhs._range; }
+      bool operator!=(const iterator& rhs) const { return _range != rhs._range; }
+
+    private:
+      explicit iterator(block_range* range) : _range(range) {}
+      block_range* _range;
+
+      friend class block_range;
+    };
+
+    /**
+     * Create range of blocks of dataset `d_id'.
+     *
+     * @param d_id - dataset id
+     * @param path - absolute path to dataset (needed for error message)
+     * @param axis - axis to split the dataset along
+     * @param block_bytes - memory budget for a single block in bytes
+     * @param block_shape - shape of a block, overrides the budget if not empty
+     */
+    block_range(hid_t d_id, const std::string& path, size_t axis = 0, size_t block_bytes = internal::default_block_bytes,
+                const std::vector<size_t>& block_shape = {}) : _d_id(d_id), _path(path), _axis(axis), _finished(true) {
+      auto dims = internal::dataset_dims(d_id);
+      if (dims.size() == 0 ? axis != 0 : axis >= dims.size()) {
+        throw hdf5_read_error("Dataset " + path + " does not have axis " + std::to_string(axis));
+      }
+      _shape.assign(dims.begin(), dims.end());
+      _block_shape = block_shape.empty() ? internal::aligned_block_shape(d_id, dims, axis, sizeof(T), block_bytes) : block_shape;
+      if (_block_shape.size() != _shape.size()) {
+        throw hdf5_read_error("Block shape does not match rank of dataset " + path);
+      }
+      size_t buffer_size = 1;
+      for (size_t i = 0; i < _shape.size(); ++i) {
+        _block_shape[i]  = std::max<size_t>(1, _block_shape[i]);
+        buffer_size     *= std::min(_block_shape[i], _shape[i]);
+      }
+      _buffer.resize(buffer_size);
+      _origin.assign(_shape.size(), 0);
+      H5Iinc_ref(_d_id);
+    }
+
+    block_range(block_range&& rhs) noexcept :
+        _d_id(rhs._d_id), _path(std::move(rhs._path)), _axis(rhs._axis), _finished(rhs._finished), _shape(std::move(rhs._shape)),
+        _block_shape(std::move(rhs._block_shape)), _origin(std::move(rhs._origin)), _buffer(std::move(rhs._buffer)),
+        _block(std::move(rhs._block)) {
+      rhs._d_id = H5I_INVALID_HID;
+    }
+    block_range(const block_range&)            = delete;
+    block_range& operator=(const block_range&) = delete;
+    block_range& operator=(block_range&&)      = delete;
+
+    ~block_range() {
+      if (_d_id != H5I_INVALID_HID) H5Idec_ref(_d_id);
+    }
+
+    /**
+     * Start reading from the first block, previously returned iterators become invalid
+     */
+    iterator                   begin() {
+      std::fill(_origin.begin(), _origin.end(), 0);
+      _finished = size() == 0;
+      return read_next() ? iterator(this) : end();
+    }
+    iterator                   end() { return iterator(); }
+
+    /**
+     * @return number of blocks
+     */
+    size_t                     size() const {
+      size_t blocks = 1;
+      for (size_t i = 0; i < _shape.size(); ++i) blocks *= (_shape[i] + _block_shape[i] - 1) / _block_shape[i];
+      return blocks;
+    }
+    /**
+     * @return number of slabs in a block along the iterated axis, the last block can be smaller
+     */
+    size_t                     block_extent() const { return _shape.empty() ? 1 : _block_shape[_axis]; }
+    /**
+     * @return shape of a block, blocks at the end of every axis can be smaller
+     */
+    const std::vector<size_t>& block_shape() const { return _block_shape; }
+    /**
+     * @return shape of the dataset
+     */
+    const std::vector<size_t>& shape() const { return _shape; }
+
+  private:
+    hid_t               _d_id;
+    std::string         _path;
+    size_t              _axis;
+    bool                _finished;
+    std::vector<size_t> _shape;
+    std::vector<size_t> _block_shape;
+    // position of the next block
+    std::vector<size_t> _origin;
+    std::vector<T>      _buffer;
+    dataset_block<T>    _block;
+
+    bool                read_next() {
+      if (_finished) return false;
+      std::vector<size_t> counts(_shape.size());
+      for (size_t i = 0; i < _shape.size(); ++i) counts[i] = std::min(_block_shape[i], _shape[i] - _origin[i]);
+      if (_shape.empty()) {
+        read_dataset(_d_id, _path, _buffer.data());
+      } else {
+        read_hyperslab(_d_id, _path, _origin, counts, _buffer.data());
+      }
+      // view is rebuilt only when the block shape changes at the end of an axis
+      if (_block.view.data() == nullptr || _block.view.shape() != counts) {
+        _block.view = array_view<const T>(_buffer.data(), counts);
+      }
+      _block.offset = _shape.empty() ? 0 : _origin[_axis];
+      _block.origin = _origin;
+      advance();
+      return true;
+    }
+
+    /**
+     * Move origin to the next block, split axes that follow the iterated axis change fastest
+     */
+    void advance() {
+      for (size_t j = _shape.size(); j-- > 0;) {
+        // iteration order is the iterated axis first and then the remaining axes, same as in `aligned_block_shape'
+        size_t i    = j == 0 ? _axis : (j <= _axis ? j - 1 : j);
+        _origin[i] += _block_shape[i];
+        if (_origin[i] < _shape[i]) return;
+        _origin[i] = 0;
+      }
+      _finished = true;
+    }
+  };
+
+}  // namespace green::h5pp
+
+#endif  // H5PP_BLOCKS_H
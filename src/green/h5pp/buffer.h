@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#ifndef H5PP_BUFFER_H
+#define H5PP_BUFFER_H
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <numeric>
+#include <vector>
+
+namespace green::h5pp {
+
+  /**
+   * Standard allocator that returns memory aligned to `Alignment' bytes, e.g. for SIMD kernels.
+   *
+   * @tparam T - type of allocated elements
+   * @tparam Alignment - alignment in bytes, should be a power of two
+   */
+  template <typename T, size_t Alignment = 64>
+  struct aligned_allocator {
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment should be a power of two");
+    static_assert(Alignment >= alignof(T), "Alignment should not be smaller than alignment of the type");
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+      using other = aligned_allocator<U, Alignment>;
+    };
+
+    aligned_allocator() = default;
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+    T*   allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment))); }
+    void deallocate(T* p, size_t) noexcept { ::operator delete(p, std::align_val_t(Alignment)); }
+
+    template <typename U>
+    bool operator==(const aligned_allocator<U, Alignment>&) const noexcept {
+      return true;
+    }
+    template <typename U>
+    bool operator!=(const aligned_allocator<U, Alignment>&) const noexcept {
+      return false;
+    }
+  };
+
+  /**
+   * Owning contiguous multidimensional array in row-major order with user defined allocator. Buffer satisfies
+   * requirements of resizable N-dimensional container, so it can be used directly as a target of `operator>>' and
+   * as a source of `operator<<'.
+   *
+   * @tparam T - type of array elements
+   * @tparam Allocator - allocator, memory is 64-byte aligned by default. Stateful allocators, e.g.
+   *                     std::pmr::polymorphic_allocator on top of an arena, are supported.
+   */
+  template <typename T, typename Allocator = aligned_allocator<T>>
+  class ndbuffer {
+  public:
+    using value_type     = T;
+    using allocator_type = Allocator;
+
+    explicit ndbuffer(const Allocator& alloc = Allocator()) : _data(alloc) {}
+    explicit ndbuffer(const std::vector<size_t>& shape, const Allocator& alloc = Allocator()) : _data(alloc) { resize(shape); }
+
+    T*                         data() { return _data.data(); }
+    const T*                   data() const { return _data.data(); }
+    size_t                     size() const { return _data.size(); }
+    const std::vector<size_t>& shape() const { return _shape; }
+    allocator_type             get_allocator() const { return _data.get_allocator(); }
+
+    /**
+     * Change shape of the buffer, memory is reallocated only if the new size exceeds current capacity.
+     *
+     * @param shape - new shape
+     */
+    void                       resize(const std::vector<size_t>& shape) {
+      _shape = shape;
+      _data.resize(std::accumulate(shape.begin(), shape.end(), 1ul, std::multiplies<>()));
+    }
+
+    T&       operator[](size_t i) { return _data[i]; }
+    const T& operator[](size_t i) const { return _data[i]; }
+    T*       begin() { return _data.data(); }
+    T*       end() { return _data.data() + _data.size(); }
+    const T* begin() const { return _data.data(); }
+    const T* end() const { return _data.data() + _data.size(); }
+
+  private:
+    std::vector<T, Allocator> _data;
+    std::vector<size_t>       _shape;
+  };
+
+}  // namespace green::h5pp
+
+#endif  // H5PP_BUFFER_H
@@ -9,10 +9,14 @@
 #include <hdf5.h>
 #include <hdf5_hl.h>
 
+#include <cstdint>
 #include <cstring>
+#include <memory>
 #include <numeric>
+#include <typeindex>
 
 #include "except.h"
+#include "shape.h"
 #include "type_traits.h"
 #include "utils.h"
 
@@ -60,7 +64,7 @@ namespace green::h5pp {
      * @return corresponding H5 type id for the data
      */
     template <typename T>
-    std::enable_if_t<is_scalar<T> && !is_complex_scalar<T>, hid_t> get_type_id(const T&) {
+    std::enable_if_t<is_scalar<T> && !is_complex_scalar<T> && !is_compound_scalar<T>, hid_t> get_type_id(const T&) {
       return hdf5_typename<std::remove_const_t<T>>::type;
     }
 
@@ -79,6 +83,9 @@ namespace green::h5pp {
       return tid;
     }
 
+    template <typename T>
+    std::enable_if_t<is_compound_scalar<T>, hid_t> get_type_id(const T&);
+
     inline hid_t get_type_id(const std::string&) {
       hid_t tid = H5Tcopy(H5T_C_S1);
       H5Tset_size(tid, H5T_VARIABLE);
@@ -86,6 +93,74 @@ namespace green::h5pp {
       return tid;
     }
 
+    /**
+     * Create H5 array type of `n' elements of `base_id', array base type is closed since it is copied into the array type
+     */
+    inline hid_t array_type_id(hid_t base_id, hsize_t n) {
+      hid_t tid = H5Tarray_create2(base_id, 1, &n);
+      if (H5Tget_class(base_id) == H5T_ARRAY) H5Tclose(base_id);
+      return tid;
+    }
+
+    /**
+     * Get H5 type id for a member of compound type, fixed size arrays are mapped to H5 array types. Array types are created
+     * on each call and should be closed by the caller.
+     *
+     * @tparam M - type of the member
+     * @return corresponding H5 data type
+     */
+    template <typename M>
+    hid_t member_type_id() {
+      if constexpr (std::is_array_v<M>) {
+        return array_type_id(member_type_id<std::remove_extent_t<M>>(), std::extent_v<M>);
+      } else if constexpr (is_std_array_t<M>::value) {
+        return array_type_id(member_type_id<typename M::value_type>(), std::tuple_size_v<M>);
+      } else {
+        static_assert(is_scalar<M>, "Compound type members should be scalars, registered compound types or arrays of them");
+        return get_type_id(M{});
+      }
+    }
+
+    /**
+     * Insert member described by `field' into compound type `id'
+     *
+     * @return `true' if member was inserted
+     */
+    template <typename C, typename M>
+    bool insert_member(hid_t id, const compound_field<C, M>& field) {
+      hid_t  member_id = member_type_id<M>();
+      herr_t status    = H5Tinsert(id, field.name, field.offset, member_id);
+      if (H5Tget_class(member_id) == H5T_ARRAY) H5Tclose(member_id);
+      return status >= 0;
+    }
+
+    /**
+     * Get H5 compound type for registered struct. Type is created once and reused.
+     *
+     * @tparam T - registered struct type
+     * @return H5 compound type for `T'
+     */
+    template <typename T>
+    std::enable_if_t<is_compound_scalar<T>, hid_t> get_type_id(const T&) {
+      using type = std::remove_cv_t<std::remove_reference_t<T>>;
+      static_assert(std::is_trivially_copyable_v<type> && std::is_standard_layout_v<type>,
+                    "Only trivially copyable standard layout structs can be mapped into compound type");
+      static hid_t tid = [] {
+        hid_t       id = H5Tcreate(H5T_COMPOUND, sizeof(type));
+        const char* failed = nullptr;
+        auto        insert = [id, &failed](const auto& field) {
+          if (failed == nullptr && !insert_member(id, field)) failed = field.name;
+        };
+        std::apply([&insert](const auto&... fields) { (insert(fields), ...); }, compound_traits<type>::fields());
+        if (failed != nullptr) {
+          H5Tclose(id);
+          throw hdf5_unsupported_type_error("Can not insert field '"s + failed + "' into compound type");
+        }
+        return id;
+      }();
+      return tid;
+    }
+
     /**
      * Get underlying H5 type for 1+ dimensional data
      * @tparam T - non-scalar datatype
@@ -101,18 +176,52 @@ namespace green::h5pp {
      * Create all necessary parent groups for current new H5 object
      *
      * @param root_parent - h5 id of the parent object the current object was created
-     * @param parents_list - the full list of parent objects
+     * @param name - path of the new object, all components except the last one are parent groups
      */
-    inline void create_parents(hid_t root_parent, std::vector<std::string>& parents_list) {
-      std::string current_root = "";
-      for (auto parent : parents_list) {
-        current_root += "/" + parent;
-        htri_t check = H5Lexists(root_parent, current_root.c_str(), H5P_DEFAULT);
-        if (check <= 0) {
-          hid_t g_id = H5Gcreate2(root_parent, current_root.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-          H5Gclose(g_id);
+    inline void create_parents(hid_t root_parent, std::string_view name) {
+      thread_local utils::path_builder current_root;
+      std::string_view                 parent;
+      current_root.clear();
+      utils::for_each_token(name, '/', [&](std::string_view token) {
+        if (!parent.empty()) {
+          current_root.append(parent);
+          htri_t check = H5Lexists(root_parent, current_root.c_str(), H5P_DEFAULT);
+          if (check <= 0) {
+            hid_t g_id = H5Gcreate2(root_parent, current_root.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+            H5Gclose(g_id);
+          }
         }
+        parent = token;
+      });
+    }
+
+    /**
+     * @param d_id - dataset id
+     * @return shape of the dataset
+     */
+    inline shape_buffer<hsize_t> dataset_dims(hid_t d_id) {
+      hid_t space_id = H5Dget_space(d_id);
+      auto  dims     = dataspace_dims(space_id);
+      H5Sclose(space_id);
+      return dims;
+    }
+
+    /**
+     * Choose chunk shape for a dataset of shape `dims'. Largest dimensions are halved until chunk fits into ~1MiB.
+     *
+     * @param dims - shape of the dataset
+     * @param type_size - size of a dataset element in bytes
+     * @return chunk shape
+     */
+    inline shape_buffer<hsize_t> chunk_shape(const shape_buffer<hsize_t>& dims, size_t type_size) {
+      shape_buffer<hsize_t> chunk(dims);
+      for (auto& c : chunk) c = std::max<hsize_t>(c, 1);
+      while (std::accumulate(chunk.begin(), chunk.end(), hsize_t(type_size), std::multiplies<>()) > (1ul << 20)) {
+        auto largest = std::max_element(chunk.begin(), chunk.end());
+        if (*largest == 1) break;
+        *largest = (*largest + 1) / 2;
       }
+      return chunk;
     }
 
     /**
@@ -120,44 +229,46 @@ namespace green::h5pp {
      *
      * @tparam T - datatype of the source data
      * @param rhs - source data, can be scalar, array, vector or multi-dimensional array
-     * @return pair of dimension and shape of target dataset
+     * @return pair of dimension and shape of target dataset. Shape is stored in place: std::array for scalars, 1D arrays
+     * and containers with std::array shape, fixed-capacity buffer for containers with runtime rank.
      */
     template <typename T>
-    std::pair<int, std::vector<size_t>> extract_dataset_shape(const T& rhs) {
-      int                 rank = -1;
-      std::vector<size_t> dims(0);
+    auto extract_dataset_shape(const T& rhs) {
       if constexpr (is_scalar<T> || is_string<T>) {
-        rank = 0;
+        return std::make_pair(0, std::array<size_t, 0>{});
       } else if constexpr (is_1D_array<T>) {
-        rank = 1;
-        dims.push_back(rhs.size());
-      } else if constexpr (is_ND_array<T>) {
-        rank = rhs.shape().size();
-        dims.resize(rank);
+        return std::make_pair(1, std::array<size_t, 1>{size_t(rhs.size())});
+      } else if constexpr (is_ND_array<T> && static_rank<T>::value >= 0) {
+        constexpr int                        rank = static_rank<T>::value;
+        std::array<size_t, size_t(rank)> dims;
         std::copy(rhs.shape().begin(), rhs.shape().end(), dims.begin());
+        return std::make_pair(rank, dims);
+      } else if constexpr (is_ND_array<T>) {
+        shape_buffer<size_t> dims(rhs.shape().begin(), rhs.shape().end());
+        return std::make_pair(int(dims.size()), dims);
       } else {
         throw hdf5_unsupported_type_error("Type "s + typeid(T).name() + " is not supported in current implementation");
+        return std::make_pair(-1, shape_buffer<size_t>());
       }
-      return std::make_pair(rank, dims);
     }
 
     template <typename T>
     std::enable_if_t<!std::is_same_v<std::decay_t<T>, std::string> && !std::is_same_v<std::decay_t<T>, std::vector<std::string>>>
-    write(hid_t d_id, hid_t type_id, hid_t dataspace_id, T&& rhs) {
+    write(hid_t d_id, hid_t type_id, hid_t dataspace_id, T&& rhs, hid_t memspace_id = H5S_ALL) {
       const void* data;
       if constexpr (is_scalar<T>)
         data = &rhs;
       else if constexpr (is_1D_array<T> || is_ND_array<T>)
         data = rhs.data();
-      H5Dwrite(d_id, type_id, H5S_ALL, dataspace_id, H5P_DEFAULT, data);
+      H5Dwrite(d_id, type_id, memspace_id, dataspace_id, H5P_DEFAULT, data);
     }
 
     template <typename T>
     std::enable_if_t<std::is_same_v<std::decay_t<T>, std::string> || std::is_same_v<std::decay_t<T>, std::vector<std::string>>>
-    write(hid_t d_id, hid_t type_id, hid_t dataspace_id, T&& rhs) {
+    write(hid_t d_id, hid_t type_id, hid_t dataspace_id, T&& rhs, hid_t memspace_id = H5S_ALL) {
       if constexpr (std::is_same_v<std::decay_t<T>, std::string>) {
         const void* data = rhs.c_str();
-        H5Dwrite(d_id, type_id, H5S_ALL, dataspace_id, H5P_DEFAULT, &data);
+        H5Dwrite(d_id, type_id, memspace_id, dataspace_id, H5P_DEFAULT, &data);
       } else {
         char** data = new char*[rhs.size()];
         int    i    = 0;
@@ -166,7 +277,7 @@ namespace green::h5pp {
           strcpy(data[i], it.c_str());
           ++i;
         }
-        H5Dwrite(d_id, type_id, H5S_ALL, dataspace_id, H5P_DEFAULT, data);
+        H5Dwrite(d_id, type_id, memspace_id, dataspace_id, H5P_DEFAULT, data);
         for (unsigned int i = 0; i < rhs.size(); i++) {
           delete[] data[i];
         }
@@ -204,6 +315,93 @@ namespace green::h5pp {
       if (H5Dvlen_reclaim(tid, space_id, H5P_DEFAULT, data) < 0)
         throw hdf5_read_error("Cannot free resources for variable-length string type");
     }
+
+    // name of the attribute that stores content hash of a dataset written with change tracking
+    inline constexpr const char* content_hash_attribute = "h5pp_hash";
+    // attribute of a dataset registered in the deduplication index that holds its index key
+    inline constexpr const char* dedup_key_attribute    = "h5pp_dedup_key";
+
+    /**
+     * Fast non-cryptographic 64-bit hash of `size' bytes starting from `data'.
+     *
+     * @param data - pointer to the first byte
+     * @param size - number of bytes
+     * @param seed - initial state, used to combine hashes
+     * @return hash value
+     */
+    uint64_t hash_bytes(const void* data, size_t size, uint64_t seed = 0);
+
+    /**
+     * Hash of the full description of H5 type `type_id', including sign, byte order and layout of compound members.
+     *
+     * @param type_id - H5 type
+     * @param seed - initial state, used to combine hashes
+     * @return hash value
+     */
+    uint64_t hash_type(hid_t type_id, uint64_t seed = 0);
+
+    /**
+     * Append bytes of the members of `element' to `out'. Members of compound types are appended one by one, so that struct
+     * padding, which has unspecified content, does not affect the result.
+     */
+    template <typename E>
+    void pack_members(const E& element, std::string& out) {
+      if constexpr (is_compound_scalar<E>) {
+        std::apply([&](const auto&... fields) { (pack_members(element.*(fields.member), out), ...); },
+                   compound_traits<E>::fields());
+      } else if constexpr (std::is_array_v<E> || is_std_array_t<E>::value) {
+        for (const auto& item : element) pack_members(item, out);
+      } else {
+        out.append(reinterpret_cast<const char*>(&element), sizeof(element));
+      }
+    }
+
+    /**
+     * Hash of `count' elements starting from `data'. Elements of compound types are packed member by member in blocks.
+     */
+    template <typename E>
+    uint64_t hash_elements(const E* data, size_t count, uint64_t seed) {
+      if constexpr (is_compound_scalar<E>) {
+        constexpr size_t block = 4096;
+        std::string      packed;
+        for (size_t begin = 0; begin < count; begin += block) {
+          packed.clear();
+          for (size_t i = begin; i < std::min(count, begin + block); ++i) pack_members(data[i], packed);
+          seed = hash_bytes(packed.data(), packed.size(), seed);
+        }
+        return seed;
+      } else {
+        return hash_bytes(data, count * sizeof(E), seed);
+      }
+    }
+
+    /**
+     * Compute hash of the data to be written into a dataset. Hash covers full description of the element type, shape and
+     * content of the data, so that datasets with the same bytes but different shapes or types are distinguished.
+     *
+     * @tparam T - type of the data
+     * @param rhs - data to be hashed
+     * @return hash value
+     */
+    template <typename T>
+    uint64_t content_hash(const T& rhs) {
+      auto [rank, dims] = extract_dataset_shape(rhs);
+      uint64_t hash     = hash_type(get_type_id(rhs), uint64_t(rank));
+      hash              = hash_bytes(dims.data(), dims.size() * sizeof(size_t), hash);
+      if constexpr (is_string<T>) {
+        return hash_bytes(rhs.data(), rhs.size(), hash);
+      } else if constexpr (is_scalar<T>) {
+        return hash_elements(&rhs, 1, hash);
+      } else if constexpr (std::is_same_v<std::decay_t<T>, std::vector<std::string>>) {
+        for (const auto& str : rhs) {
+          uint64_t length = str.size();
+          hash            = hash_bytes(str.data(), str.size(), hash_bytes(&length, sizeof(length), hash));
+        }
+        return hash;
+      } else {
+        return hash_elements(rhs.data(), size_t(rhs.size()), hash);
+      }
+    }
   }  // namespace internal
 
   /**
@@ -336,14 +534,14 @@ namespace green::h5pp {
    * @return `true' if dataset exists
    */
   inline bool dataset_exists(hid_t root_parent, const std::string& name) {
-    std::vector<std::string> branch   = utils::split(name, "/");
-    std::string              to_check = "";
-    for (auto item : branch) {
-      to_check += "/" + item;
-      htri_t check = H5Lexists(root_parent, to_check.c_str(), H5P_DEFAULT);
-      if (check <= 0) {
-        return false;
-      }
+    thread_local utils::path_builder to_check;
+    bool                             exists = true;
+    to_check.clear();
+    utils::for_each_token(name, '/', [&](std::string_view item) {
+      exists = exists && H5Lexists(root_parent, to_check.append(item).c_str(), H5P_DEFAULT) > 0;
+    });
+    if (!exists) {
+      return false;
     }
     bool        res = false;
     hdf5_info_t info;
@@ -367,14 +565,23 @@ namespace green::h5pp {
     const auto           current_id = H5Dopen2(root_parent, name.c_str(), H5P_DEFAULT);
     const auto           space_id   = H5Dget_space(current_id);
 
-    const auto           src_rank   = H5Sget_simple_extent_ndims(space_id);
-    std::vector<hsize_t> int_dims(src_rank);
-    H5Sget_simple_extent_dims(space_id, int_dims.data(), NULL);
-    std::vector<size_t> shape(int_dims.begin(), int_dims.end());
+    const auto           int_dims   = internal::dataspace_dims(space_id);
+    std::vector<size_t>  shape(int_dims.begin(), int_dims.end());
+    H5Sclose(space_id);
     H5Dclose(current_id);
     return shape;
   }
 
+  /**
+   * Policy for updating existing dataset with data of a different shape
+   */
+  enum overwrite_policy {
+    // throw an exception if shapes are different
+    STRICT_OVERWRITE,
+    // resize chunked dataset in place if its maximal dimensions allow it, otherwise create the dataset again
+    RESIZE_OVERWRITE
+  };
+
   /**
    * Write `rhs' into dataset with id=d_id. For scalar `rhs' `hdf5_not_a_scalar_error' will be thrown if
    * target dataset is not scalar or has more than a single element. For 1+ dimensional `rhs' `hdf5_write_error' will be
@@ -386,24 +593,20 @@ namespace green::h5pp {
    */
   template <typename T>
   void write_dataset(hid_t d_id, const std::string& path, T&& rhs) {
-    hid_t                type_id      = internal::get_type_id(rhs);
-    hid_t                dataspace_id = H5Dget_space(d_id);
-    size_t               dst_rank     = H5Sget_simple_extent_ndims(dataspace_id);
-    std::vector<hsize_t> int_dims(dst_rank);
-    H5Sget_simple_extent_dims(dataspace_id, int_dims.data(), NULL);
-    std::vector<size_t> dst_dims(int_dims.begin(), int_dims.end());
+    hid_t type_id             = internal::get_type_id(rhs);
+    hid_t dataspace_id        = H5Dget_space(d_id);
+    auto  dst_dims            = internal::dataspace_dims(dataspace_id);
     auto [src_rank, src_dims] = internal::extract_dataset_shape(rhs);
     if constexpr (is_scalar<T> || is_string<T>) {
-      if (dst_rank != 0 && std::accumulate(dst_dims.begin(), dst_dims.end(), 1ul, std::multiplies<>()) != 1) {
+      if (dst_dims.size() != 0 && internal::shape_size(dst_dims) != 1) {
         throw hdf5_not_a_scalar_error("Dataset " + path + " contains non scalar data.");
       }
     } else if constexpr (is_1D_array<T>) {
-      if (std::accumulate(dst_dims.begin(), dst_dims.end(), 1ul, std::multiplies<>()) !=
-          std::accumulate(src_dims.begin(), src_dims.end(), 1ul, std::multiplies<>())) {
+      if (internal::shape_size(dst_dims) != internal::shape_size(src_dims)) {
         throw hdf5_write_error("Source container's shape and dataset " + path + "'s shape are different.");
       }
     } else if constexpr (is_ND_array<T>) {
-      if (dst_rank != src_rank || dst_dims != src_dims) {
+      if (!internal::same_shape(dst_dims, src_dims)) {
         throw hdf5_write_error("Source container's shape and dataset " + path + "'s shape are different.");
       }
     } else {
@@ -434,6 +637,51 @@ namespace green::h5pp {
    */
   void move_group(hid_t src_loc_id, const std::string& src_name, hid_t dst_loc_id, const std::string& dst_name);
 
+  /**
+   * Options for copying of HDF5 objects
+   */
+  struct copy_options {
+    // copy only immediate members of a group
+    bool shallow               = false;
+    // copy objects pointed by soft links instead of links themselves
+    bool expand_soft_links     = false;
+    // copy objects pointed by external links instead of links themselves
+    bool expand_external_links = false;
+    // copy attributes of the objects
+    bool preserve_attributes   = true;
+  };
+
+  /**
+   * Get interned copy of absolute path `path'. Interned paths are stored in a process-wide table and are never released.
+   *
+   * @param path - absolute path
+   * @return shared interned path
+   */
+  std::shared_ptr<const std::string> intern_path(const std::string& path);
+
+  /**
+   * Get interned path of child `name' of the interned path `parent'. Lookup does not allocate if the child has been
+   * interned before.
+   *
+   * @param parent - interned path of the parent object
+   * @param name - relative path of the child
+   * @return shared interned path of the child
+   */
+  std::shared_ptr<const std::string> intern_path(const std::shared_ptr<const std::string>& parent, const std::string& name);
+
+  /**
+   * Copy group or dataset to a new location, possibly in another file. Raw data is copied as is, without
+   * decompression and recompression of chunks. All missing parent groups of the destination will be created.
+   *
+   * @param src_loc_id id of file or group of a source
+   * @param src_name name of an object to be copied relative to a source
+   * @param dst_loc_id id of file or group of a desitnation
+   * @param dst_name name of the copy at the destination
+   * @param options copy options
+   */
+  void copy_object(hid_t src_loc_id, const std::string& src_name, hid_t dst_loc_id, const std::string& dst_name,
+                   const copy_options& options = {});
+
   /**
    * Create dataset at `name' path for `root_parent' object and write `rhs' data into it.
    * Absolute path is used if `name' starts with `/', otherwise the path is relative to `root_parent'.
@@ -443,19 +691,26 @@ namespace green::h5pp {
    * @param root_parent - id of the parent group
    * @param name - path of the dataset to be written
    * @param rhs
+   * @param resizable - create chunked dataset with unlimited maximal dimensions, so it can be resized in place later
    * @return
    */
   template <typename T>
-  hid_t create_dataset(hid_t root_parent, const std::string& name, T&& rhs) {
-    std::vector<std::string> branch = utils::split(name, "/");
-    std::vector<std::string> parents_list(branch.begin(), branch.end() - 1);
-    internal::create_parents(root_parent, parents_list);
+  hid_t create_dataset(hid_t root_parent, const std::string& name, T&& rhs, bool resizable = false) {
+    internal::create_parents(root_parent, name);
     auto [rank, int_dims] = internal::extract_dataset_shape(rhs);
-    std::vector<hsize_t> dims(int_dims.begin(), int_dims.end());
-    hid_t                dataspace_id = is_scalar<T> ? H5Screate(H5S_SCALAR) : H5Screate_simple(rank, dims.data(), NULL);
-    hid_t                type_id      = internal::get_type_id(rhs);
-    // else type_id = get_type_id(*rhs.data());
-    hid_t d_id = H5Dcreate2(root_parent, name.c_str(), type_id, dataspace_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    internal::shape_buffer<hsize_t> dims(int_dims.begin(), int_dims.end());
+    internal::shape_buffer<hsize_t> max_dims(rank, H5S_UNLIMITED);
+    resizable          = resizable && rank > 0;
+    hid_t dataspace_id = is_scalar<T> ? H5Screate(H5S_SCALAR)
+                                      : H5Screate_simple(rank, dims.data(), resizable ? max_dims.data() : NULL);
+    hid_t type_id      = internal::get_type_id(rhs);
+    hid_t dcpl         = H5Pcreate(H5P_DATASET_CREATE);
+    if (resizable) {
+      auto chunk = internal::chunk_shape(dims, H5Tget_size(type_id));
+      H5Pset_chunk(dcpl, rank, chunk.data());
+    }
+    hid_t d_id = H5Dcreate2(root_parent, name.c_str(), type_id, dataspace_id, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    H5Pclose(dcpl);
     if (d_id == H5I_INVALID_HID) {
       throw hdf5_create_dataset_error("Can not create dataset " + name);
     }
@@ -466,6 +721,304 @@ namespace green::h5pp {
     return d_id;
   }
 
+  /**
+   * Write `rhs' into dataset `d_id' adjusting the dataset shape to the shape of `rhs' if they are different.
+   * Chunked dataset is resized in place if its maximal dimensions allow it. Otherwise the dataset is unlinked and created
+   * again as resizable dataset, so that the following updates can be done in place and space of the old dataset can be reused.
+   *
+   * @tparam T - type of the source data
+   * @param root_parent - id of the parent group of the dataset
+   * @param d_id - dataset id, closed if the dataset was created again and left open if an exception is thrown
+   * @param path - path to the dataset relative to `root_parent'
+   * @param rhs - data to be written into dataset
+   * @return id of the updated dataset, it differs from `d_id' if the dataset was created again
+   */
+  template <typename T>
+  hid_t resize_and_write_dataset(hid_t root_parent, hid_t d_id, const std::string& path, T&& rhs) {
+    internal::shape_buffer<hsize_t> max_dims;
+    hid_t                           dataspace_id = H5Dget_space(d_id);
+    auto                            dst_dims     = internal::dataspace_dims(dataspace_id, &max_dims);
+    H5Sclose(dataspace_id);
+    size_t dst_rank           = dst_dims.size();
+    auto [src_rank, src_dims] = internal::extract_dataset_shape(rhs);
+    size_t dst_size           = internal::shape_size(dst_dims);
+    size_t src_size           = internal::shape_size(src_dims);
+    bool   same_shape;
+    if constexpr (is_scalar<T> || is_string<T>) {
+      same_shape = dst_size == 1;
+    } else if constexpr (is_1D_array<T>) {
+      same_shape = dst_rank != 0 && dst_size == src_size;
+    } else {
+      same_shape = internal::same_shape(dst_dims, src_dims);
+    }
+    if (same_shape) {
+      write_dataset(d_id, path, rhs);
+      return d_id;
+    }
+    hid_t dcpl    = H5Dget_create_plist(d_id);
+    bool  chunked = H5Pget_layout(dcpl) == H5D_CHUNKED;
+    H5Pclose(dcpl);
+    bool fits = chunked && dst_rank == size_t(src_rank) &&
+                std::equal(src_dims.begin(), src_dims.end(), max_dims.begin(),
+                           [](size_t src, hsize_t max) { return max == H5S_UNLIMITED || src <= max; });
+    if (fits) {
+      internal::shape_buffer<hsize_t> new_dims(src_dims.begin(), src_dims.end());
+      if (H5Dset_extent(d_id, new_dims.data()) < 0) {
+        throw hdf5_write_error("Can not resize dataset " + path);
+      }
+      write_dataset(d_id, path, rhs);
+      return d_id;
+    }
+    // old dataset is closed only after it is replaced, so that `d_id' stays valid for the caller if replacement fails
+    if (H5Ldelete(root_parent, path.c_str(), H5P_DEFAULT) < 0) {
+      throw hdf5_write_error("Can not unlink dataset " + path);
+    }
+    hid_t new_id;
+    try {
+      new_id = create_dataset(root_parent, path, rhs, true);
+    } catch (...) {
+      // keep the old dataset linked at its path
+      H5Olink(d_id, root_parent, path.c_str(), H5P_DEFAULT, H5P_DEFAULT);
+      throw;
+    }
+    H5Dclose(d_id);
+    return new_id;
+  }
+
+  /**
+   * Create extendable dataset at `name' path for `root_parent' object. Dataset is created empty with a leading unlimited
+   * dimension, each record along this dimension has the shape of `rhs'. Records are added with `append_dataset'.
+   * All parent groups will be created if needed.
+   *
+   * @tparam T - type of a single record
+   * @param root_parent - id of the parent group
+   * @param name - path of the dataset to be created
+   * @param rhs - record that defines type and shape of the dataset elements
+   * @return id of newly created dataset
+   */
+  template <typename T>
+  hid_t create_extendable_dataset(hid_t root_parent, const std::string& name, const T& rhs) {
+    internal::create_parents(root_parent, name);
+    auto [rank, int_dims] = internal::extract_dataset_shape(rhs);
+    internal::shape_buffer<hsize_t> dims(rank + 1, 0);
+    internal::shape_buffer<hsize_t> max_dims(rank + 1, H5S_UNLIMITED);
+    internal::shape_buffer<hsize_t> chunk(rank + 1, 1);
+    std::copy(int_dims.begin(), int_dims.end(), dims.begin() + 1);
+    std::copy(int_dims.begin(), int_dims.end(), max_dims.begin() + 1);
+    std::copy(int_dims.begin(), int_dims.end(), chunk.begin() + 1);
+    hid_t type_id = internal::get_type_id(rhs);
+    // keep chunks of small records reasonably large, HDF5 can not efficiently handle a lot of tiny chunks
+    size_t record_bytes = std::max<size_t>(
+        1, H5Tget_size(type_id) * internal::shape_size(int_dims));
+    chunk[0] = std::max<size_t>(1, (64ul << 10) / record_bytes);
+    for (size_t i = 1; i <= size_t(rank); ++i) chunk[i] = std::max<hsize_t>(chunk[i], 1);
+    hid_t dataspace_id = H5Screate_simple(rank + 1, dims.data(), max_dims.data());
+    hid_t dcpl         = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(dcpl, rank + 1, chunk.data());
+    hid_t d_id = H5Dcreate2(root_parent, name.c_str(), type_id, dataspace_id, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    H5Pclose(dcpl);
+    H5Sclose(dataspace_id);
+    if (d_id == H5I_INVALID_HID) {
+      throw hdf5_create_dataset_error("Can not create dataset " + name);
+    }
+    return d_id;
+  }
+
+  /**
+   * Append `rhs' as a new record along the leading dimension of the extendable dataset `d_id'. `hdf5_write_error' will be
+   * thrown if dataset is not extendable or if shape of `rhs' differs from the record shape of the dataset.
+   *
+   * @tparam T - type of the source data
+   * @param d_id - dataset id
+   * @param path - absolute path to dataset (needed for error message)
+   * @param rhs - record to be appended
+   */
+  template <typename T>
+  void append_dataset(hid_t d_id, const std::string& path, const T& rhs) {
+    internal::shape_buffer<hsize_t> max_dims;
+    hid_t                           dataspace_id = H5Dget_space(d_id);
+    auto                            dims         = internal::dataspace_dims(dataspace_id, &max_dims);
+    H5Sclose(dataspace_id);
+    size_t dst_rank = dims.size();
+    auto [src_rank, src_dims] = internal::extract_dataset_shape(rhs);
+    if (dst_rank == 0 || (max_dims[0] != H5S_UNLIMITED && max_dims[0] <= dims[0])) {
+      throw hdf5_write_error("Dataset " + path + " is not extendable.");
+    }
+    if (dst_rank != size_t(src_rank) + 1 || !std::equal(src_dims.begin(), src_dims.end(), dims.begin() + 1)) {
+      throw hdf5_write_error("Source container's shape and record shape of dataset " + path + " are different.");
+    }
+    internal::shape_buffer<hsize_t> offset(dst_rank, 0);
+    internal::shape_buffer<hsize_t> count(dims);
+    offset[0] = dims[0];
+    count[0]  = 1;
+    ++dims[0];
+    if (H5Dset_extent(d_id, dims.data()) < 0) {
+      throw hdf5_write_error("Can not extend dataset " + path);
+    }
+    dataspace_id = H5Dget_space(d_id);
+    H5Sselect_hyperslab(dataspace_id, H5S_SELECT_SET, offset.data(), NULL, count.data(), NULL);
+    hid_t memspace_id = H5Screate_simple(dst_rank, count.data(), NULL);
+    internal::write(d_id, internal::get_type_id(rhs), dataspace_id, rhs, memspace_id);
+    H5Sclose(memspace_id);
+    H5Sclose(dataspace_id);
+  }
+
+  /**
+   * Refresh dataset metadata if file is open in SWMR read mode, so that data appended by the writer becomes visible.
+   *
+   * @param file_id - id of the file
+   * @param d_id - dataset id
+   */
+  inline void refresh_dataset(hid_t file_id, hid_t d_id) {
+    unsigned intent = 0;
+    if (H5Fget_intent(file_id, &intent) >= 0 && (intent & H5F_ACC_SWMR_READ)) {
+      if (H5Drefresh(d_id) < 0) {
+        throw hdf5_read_error("Can not refresh dataset");
+      }
+    }
+  }
+
+  /**
+   * Mapping of a source dataset into a block of a virtual dataset
+   */
+  struct virtual_source {
+    // name of the file that contains source dataset, "." refers to the file of the virtual dataset.
+    // Relative names are resolved with respect to the directory of the file with virtual dataset.
+    std::string         filename;
+    // absolute path of the source dataset in its file
+    std::string         dataset;
+    // position of the source block in the virtual dataset
+    std::vector<size_t> offset;
+    // shape of the source dataset, also the shape of the block it occupies, so its rank should match the virtual dataset
+    std::vector<size_t> shape;
+  };
+
+  /**
+   * Create virtual dataset at `name' path for `root_parent' object. Each source dataset is mapped as a whole into a block
+   * of the virtual dataset, reading the virtual dataset transparently reads data from the source datasets without copying them.
+   * Sources do not need to exist at the moment of creation, unmapped elements are read as zeros.
+   * All parent groups will be created if needed.
+   *
+   * @tparam T - type of dataset elements
+   * @param root_parent - id of the parent group
+   * @param name - path of the dataset to be created
+   * @param shape - shape of the virtual dataset
+   * @param sources - list of source datasets and their positions in the virtual dataset
+   * @return id of newly created dataset
+   */
+  template <typename T>
+  std::enable_if_t<is_scalar<T>, hid_t> create_virtual_dataset(hid_t root_parent, const std::string& name,
+                                                               const std::vector<size_t>& shape,
+                                                               const std::vector<virtual_source>& sources) {
+    internal::create_parents(root_parent, name);
+    std::vector<hsize_t> dims(shape.begin(), shape.end());
+    hid_t                dataspace_id = H5Screate_simple(dims.size(), dims.data(), NULL);
+    hid_t                dcpl         = H5Pcreate(H5P_DATASET_CREATE);
+    for (const auto& source : sources) {
+      if (source.offset.size() != shape.size() || source.shape.size() != shape.size()) {
+        H5Pclose(dcpl);
+        H5Sclose(dataspace_id);
+        throw hdf5_create_dataset_error("Rank of source " + source.dataset + " and rank of virtual dataset " + name +
+                                        " are different.");
+      }
+      std::vector<hsize_t> offset(source.offset.begin(), source.offset.end());
+      std::vector<hsize_t> count(source.shape.begin(), source.shape.end());
+      hid_t                src_space_id = H5Screate_simple(count.size(), count.data(), NULL);
+      herr_t               status = H5Sselect_hyperslab(dataspace_id, H5S_SELECT_SET, offset.data(), NULL, count.data(), NULL);
+      if (status >= 0 && H5Sselect_valid(dataspace_id) > 0) {
+        status = H5Pset_virtual(dcpl, dataspace_id, source.filename.c_str(), source.dataset.c_str(), src_space_id);
+      } else {
+        status = -1;
+      }
+      H5Sclose(src_space_id);
+      if (status < 0) {
+        H5Pclose(dcpl);
+        H5Sclose(dataspace_id);
+        throw hdf5_create_dataset_error("Can not map source " + source.dataset + " into virtual dataset " + name);
+      }
+    }
+    H5Sselect_all(dataspace_id);
+    hid_t type_id = internal::get_type_id(T{});
+    hid_t d_id    = H5Dcreate2(root_parent, name.c_str(), type_id, dataspace_id, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    H5Pclose(dcpl);
+    H5Sclose(dataspace_id);
+    if (d_id == H5I_INVALID_HID) {
+      throw hdf5_create_dataset_error("Can not create dataset " + name);
+    }
+    return d_id;
+  }
+
+  namespace internal {
+    /**
+     * Check that target container matches the shape of `current_id' dataset, resize the container if it is needed and possible.
+     *
+     * @tparam T - type of target data
+     * @param current_id - id of dataset to be read
+     * @param path - absolute path to dataset (needed for error message)
+     * @param rhs - target data container
+     */
+    template <typename T>
+    void fit_target_shape(hid_t current_id, const std::string& path, T& rhs) {
+      hid_t space_id = H5Dget_space(current_id);
+      auto  src_dims = dataspace_dims(space_id);
+      H5Sclose(space_id);
+      fit_target_shape(src_dims, path, rhs);
+    }
+
+    /**
+     * Check that target container matches dataset shape `src_dims', resize the container if it is needed and possible.
+     */
+    template <typename T>
+    void fit_target_shape(const shape_buffer<hsize_t>& src_dims, const std::string& path, T& rhs) {
+      auto [dst_rank, dst_dims] = extract_dataset_shape(rhs);
+      if constexpr (is_scalar<T>) {
+        if (src_dims.size() != 0 && shape_size(src_dims) != 1) {
+          throw hdf5_not_a_scalar_error("Dataset " + path + " contains non scalar data.");
+        }
+      } else if constexpr (is_1D_array<T>) {
+        if (shape_size(dst_dims) != shape_size(src_dims)) {
+          if constexpr (is_resizable<T>) {
+            rhs.resize(shape_size(src_dims));
+          } else {
+            throw hdf5_read_error("Target container's shape and dataset's shape are different and container cannot be resized.");
+          }
+        }
+      } else if constexpr (is_ND_array<T>) {
+        if (!same_shape(src_dims, dst_dims)) {
+          if constexpr (is_resizable_nd<T>) {
+            rhs.resize(std::vector<size_t>(src_dims.begin(), src_dims.end()));
+          } else {
+            throw hdf5_read_error("Target container's shape and dataset's shape are different and container cannot be resized.");
+          }
+        }
+      }
+    }
+  }  // namespace internal
+
+  namespace internal {
+    /**
+     * Metadata of an open dataset that is kept between reads: shape, type in file and the last memory type that was checked
+     * for conversion. Valid only while the dataset is not modified.
+     */
+    struct dataset_metadata {
+      shape_buffer<hsize_t> dims;
+      hid_t                 file_type_id = H5I_INVALID_HID;
+      std::type_index       conv_type    = typeid(void);
+      // dataset may carry content hash or deduplication key attributes, writes without them skip attribute lookups
+      bool                  has_hash;
+      bool                  has_dedup_key;
+
+      explicit dataset_metadata(hid_t d_id) :
+          dims(dataset_dims(d_id)), file_type_id(H5Dget_type(d_id)), has_hash(H5Aexists(d_id, content_hash_attribute) > 0),
+          has_dedup_key(H5Aexists(d_id, dedup_key_attribute) > 0) {}
+      dataset_metadata(const dataset_metadata&)            = delete;
+      dataset_metadata& operator=(const dataset_metadata&) = delete;
+      ~dataset_metadata() {
+        if (file_type_id != H5I_INVALID_HID) H5Tclose(file_type_id);
+      }
+    };
+  }  // namespace internal
+
   /**
    * Read `current_id' dataset. For 1+ dimensional objects container size/shape willbe adjusted if the container datatype
    * allows resize/reshape. For scalar object we check that data is either 0-dimensional or has only a single element.
@@ -477,43 +1030,72 @@ namespace green::h5pp {
    */
   template <typename T>
   void read_dataset(hid_t current_id, const std::string& path, T& rhs) {
-    hid_t   space_id;
-    hsize_t src_rank;
-    space_id = H5Dget_space(current_id);
-
-    src_rank = H5Sget_simple_extent_ndims(space_id);
-    std::vector<hsize_t> int_dims(src_rank);
-    H5Sget_simple_extent_dims(space_id, int_dims.data(), NULL);
-    std::vector<size_t> src_dims(int_dims.begin(), int_dims.end());
-    auto [dst_rank, dst_dims] = internal::extract_dataset_shape(rhs);
-    if constexpr (is_scalar<T>) {
-      if (src_rank != 0 && std::accumulate(src_dims.begin(), src_dims.end(), 1ul, std::multiplies<>()) != 1) {
-        throw hdf5_not_a_scalar_error("Dataset " + path + " contains non scalar data.");
-      }
-    } else if constexpr (is_1D_array<T>) {
-      if (std::accumulate(dst_dims.begin(), dst_dims.end(), 1ul, std::multiplies<>()) !=
-          std::accumulate(src_dims.begin(), src_dims.end(), 1ul, std::multiplies<>())) {
-        if constexpr (is_resizable<T>) {
-          rhs.resize(std::accumulate(src_dims.begin(), src_dims.end(), 1ul, std::multiplies<>()));
-        } else {
-          throw hdf5_read_error("Target container's shape and dataset's shape are different and container cannot be resized.");
-        }
-      }
-    } else if constexpr (is_ND_array<T>) {
-      if (src_rank != dst_rank || src_dims != dst_dims) {
-        if constexpr (is_resizable_nd<T>) {
-          rhs.resize(src_dims);
-        } else {
-          throw hdf5_read_error("Target container's shape and dataset's shape are different and container cannot be resized.");
-        }
-      }
-    }
-    if (H5Tcompiler_conv(H5Dget_type(current_id), internal::get_type_id(rhs)) < 0) {
+    internal::fit_target_shape(current_id, path, rhs);
+    hid_t  file_type_id = H5Dget_type(current_id);
+    herr_t conv         = H5Tcompiler_conv(file_type_id, internal::get_type_id(rhs));
+    H5Tclose(file_type_id);
+    if (conv < 0) {
       throw hdf5_data_conversion_error("Can not convert data to specified type.");
     }
     internal::read(current_id, path, rhs);
   }
 
+  /**
+   * Read `current_id' dataset using previously obtained metadata, so that neither dataspace nor type of the dataset is
+   * queried again and conversion is checked only when the type of the target changes.
+   *
+   * @tparam T - type of target data
+   * @param current_id - id of dataset to be read
+   * @param path - absolute path to dataset (needed for error message)
+   * @param rhs - target data container
+   * @param metadata - cached metadata of the dataset
+   */
+  template <typename T>
+  void read_dataset(hid_t current_id, const std::string& path, T& rhs, internal::dataset_metadata& metadata) {
+    internal::fit_target_shape(metadata.dims, path, rhs);
+    if (metadata.conv_type != typeid(std::decay_t<T>)) {
+      if (H5Tcompiler_conv(metadata.file_type_id, internal::get_type_id(rhs)) < 0) {
+        throw hdf5_data_conversion_error("Can not convert data to specified type.");
+      }
+      metadata.conv_type = typeid(std::decay_t<T>);
+    }
+    internal::read(current_id, path, rhs);
+  }
+
+  /**
+   * Read single field `field' of compound dataset `current_id' into `rhs'. Only the requested field is converted and
+   * copied into the target, other fields of the records are skipped by HDF5.
+   *
+   * @tparam T - type of target data, scalar or array with elements of the field type
+   * @param current_id - id of dataset to be read
+   * @param path - absolute path to dataset (needed for error message)
+   * @param field - name of the field
+   * @param rhs - target data container
+   */
+  template <typename T>
+  void read_compound_field(hid_t current_id, const std::string& path, const std::string& field, T& rhs) {
+    hid_t file_type_id = H5Dget_type(current_id);
+    bool  has_field    = H5Tget_class(file_type_id) == H5T_COMPOUND && H5Tget_member_index(file_type_id, field.c_str()) >= 0;
+    H5Tclose(file_type_id);
+    if (!has_field) {
+      throw hdf5_read_error("Dataset " + path + " does not have field " + field);
+    }
+    internal::fit_target_shape(current_id, path, rhs);
+    hid_t elem_type_id = internal::get_type_id(rhs);
+    hid_t mem_type_id  = H5Tcreate(H5T_COMPOUND, H5Tget_size(elem_type_id));
+    H5Tinsert(mem_type_id, field.c_str(), 0, elem_type_id);
+    void* data;
+    if constexpr (is_scalar<T>)
+      data = &rhs;
+    else
+      data = rhs.data();
+    herr_t status = H5Dread(current_id, mem_type_id, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+    H5Tclose(mem_type_id);
+    if (status < 0) {
+      throw hdf5_data_conversion_error("Can not convert field " + field + " of dataset " + path + " to specified type.");
+    }
+  }
+
   /**
    * Read `current_id' dataset into a raw pointer of arithmetic types
    *
@@ -524,14 +1106,10 @@ namespace green::h5pp {
    */
   template <typename T>
   std::enable_if_t<is_scalar<T>> read_dataset(hid_t current_id, const std::string& path, T* rhs) {
-    hid_t   space_id;
-    hsize_t src_rank;
-    space_id = H5Dget_space(current_id);
-
-    src_rank = H5Sget_simple_extent_ndims(space_id);
-    std::vector<hsize_t> int_dims(src_rank);
-    H5Sget_simple_extent_dims(space_id, int_dims.data(), NULL);
-    if (H5Tcompiler_conv(H5Dget_type(current_id), internal::get_type_id(*rhs)) < 0) {
+    hid_t  file_type_id = H5Dget_type(current_id);
+    herr_t conv         = H5Tcompiler_conv(file_type_id, internal::get_type_id(*rhs));
+    H5Tclose(file_type_id);
+    if (conv < 0) {
       throw hdf5_data_conversion_error("Can not convert data to specified type.");
     }
     void* data = rhs;
@@ -539,6 +1117,47 @@ namespace green::h5pp {
       throw hdf5_read_error("Can not read dataset " + path);
   }
 
+  /**
+   * Read hyperslab of `current_id' dataset into a contiguous buffer of arithmetic types. Hyperslab is defined by
+   * `offset' and `count' for each dimension of the dataset, buffer should have space for all selected elements.
+   *
+   * @tparam T - type of target data
+   * @param current_id - id of dataset to be read
+   * @param path - absolute path to dataset (needed for error message)
+   * @param offset - starting point of the hyperslab
+   * @param count - number of elements in each dimension of the hyperslab
+   * @param rhs - pointer to the target data
+   */
+  template <typename T>
+  std::enable_if_t<is_scalar<T>> read_hyperslab(hid_t current_id, const std::string& path, const std::vector<size_t>& offset,
+                                                const std::vector<size_t>& count, T* rhs) {
+    hid_t space_id = H5Dget_space(current_id);
+    int   rank     = H5Sget_simple_extent_ndims(space_id);
+    if (rank < 0 || size_t(rank) != offset.size() || size_t(rank) != count.size()) {
+      H5Sclose(space_id);
+      throw hdf5_read_error("Hyperslab rank and rank of dataset " + path + " are different.");
+    }
+    internal::shape_buffer<hsize_t> h_offset(offset.begin(), offset.end());
+    internal::shape_buffer<hsize_t> h_count(count.begin(), count.end());
+    if (H5Sselect_hyperslab(space_id, H5S_SELECT_SET, h_offset.data(), NULL, h_count.data(), NULL) < 0 ||
+        H5Sselect_valid(space_id) <= 0) {
+      H5Sclose(space_id);
+      throw hdf5_read_error("Hyperslab is out of bounds of dataset " + path);
+    }
+    hid_t  file_type_id = H5Dget_type(current_id);
+    herr_t conv         = H5Tcompiler_conv(file_type_id, internal::get_type_id(*rhs));
+    H5Tclose(file_type_id);
+    if (conv < 0) {
+      H5Sclose(space_id);
+      throw hdf5_data_conversion_error("Can not convert data to specified type.");
+    }
+    hid_t memspace_id = H5Screate_simple(rank, h_count.data(), NULL);
+    herr_t status     = H5Dread(current_id, internal::get_type_id(*rhs), memspace_id, space_id, H5P_DEFAULT, rhs);
+    H5Sclose(memspace_id);
+    H5Sclose(space_id);
+    if (status < 0) throw hdf5_read_error("Can not read dataset " + path);
+  }
+
   /**
    * Read string dataset. Variable string dataset have slightly different sintax that basic types.
    *
@@ -549,18 +1168,11 @@ namespace green::h5pp {
    */
   template <typename T>
   void read_string_dataset(hid_t current_id, const std::string& path, T& rhs) {
-    hid_t   space_id;
-    hsize_t src_rank;
-    space_id = H5Dget_space(current_id);
-
-    src_rank = H5Sget_simple_extent_ndims(space_id);
-    std::vector<hsize_t> int_dims(src_rank);
-    H5Sget_simple_extent_dims(space_id, int_dims.data(), NULL);
-    std::vector<size_t> src_dims(int_dims.begin(), int_dims.end());
-    auto [dst_rank, dst_dims] = internal::extract_dataset_shape(rhs);
-    hid_t tid                 = H5Dget_type(current_id);
+    hid_t space_id = H5Dget_space(current_id);
+    auto  src_dims = internal::dataspace_dims(space_id);
+    hid_t tid      = H5Dget_type(current_id);
     if constexpr (is_string<T>) {
-      if (src_rank != 0 && std::accumulate(src_dims.begin(), src_dims.end(), 1ul, std::multiplies<>()) != 1) {
+      if (src_dims.size() != 0 && internal::shape_size(src_dims) != 1) {
         throw hdf5_not_a_scalar_error("Dataset " + path + " contains non scalar data.");
       }
       // if (H5Sget_simple_extent_type(space_id) != H5S_SCALAR) {
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#ifndef H5PP_COMPRESSION_H
+#define H5PP_COMPRESSION_H
+
+#include "common.h"
+
+namespace green::h5pp {
+
+  /**
+   * Options for parallel compressed write
+   */
+  struct compression_options {
+    // deflate compression level
+    int    level      = 4;
+    // apply byte shuffle before compression
+    bool   shuffle    = true;
+    // number of records along the leading dimension in a single chunk, 0 to choose chunks of about 1MiB
+    size_t chunk_rows = 0;
+    // number of compression threads, 0 to use all available hardware threads
+    size_t threads    = 0;
+  };
+
+  namespace internal {
+    // type of elements of array `T'
+    template <typename T>
+    using element_type_t = std::remove_cv_t<std::remove_reference_t<decltype(*std::declval<T&>().data())>>;
+
+    /**
+     * Layout of a chunked dataset that is split only along the leading dimension
+     */
+    struct chunk_layout {
+      // number of records along the leading dimension
+      size_t rows;
+      // size of a single record in bytes
+      size_t row_bytes;
+      // number of records in a single chunk
+      size_t chunk_rows;
+      // size of a single element in bytes, used by shuffle
+      size_t element_size;
+      // rank of the dataset
+      size_t rank;
+    };
+
+    /**
+     * Split `data' into chunks, compress them on a pool of threads and write compressed chunks with H5Dwrite_chunk.
+     * All HDF5 calls are made from the calling thread.
+     */
+    void write_chunks(hid_t d_id, const std::string& path, const char* data, const chunk_layout& layout,
+                      const compression_options& options);
+
+    /**
+     * Read compressed chunks with H5Dread_chunk and decompress them into `data' on a pool of threads. Chunks that have not
+     * been allocated are filled with the fill value of the dataset. All HDF5 calls are made from the calling thread.
+     */
+    void read_chunks(hid_t d_id, const std::string& path, char* data, const chunk_layout& layout, bool shuffle, size_t threads);
+
+    /**
+     * Check if dataset `d_id' can be read chunk by chunk with `read_chunks'. Dataset should be split into chunks only along
+     * the leading dimension, filter pipeline should consist of optional shuffle followed by deflate and the type of
+     * elements in file should match `mem_type_id'.
+     *
+     * @param d_id - dataset id
+     * @param mem_type_id - type of elements in memory
+     * @param layout - layout of the dataset, filled on success
+     * @param shuffle - set to `true' if shuffle filter is used
+     * @return `true' if dataset can be read directly
+     */
+    bool direct_chunk_layout(hid_t d_id, hid_t mem_type_id, chunk_layout& layout, bool& shuffle);
+  }  // namespace internal
+
+  /**
+   * Create chunked dataset at `name' path with shuffle and deflate filters and write `rhs' into it. Data is split into chunks
+   * along the leading dimension, chunks are compressed in parallel and written directly into the file. The result is a
+   * regular compressed HDF5 dataset that can be read by any HDF5 application. All parent groups will be created if needed.
+   *
+   * @tparam T - type of the data to be written
+   * @param root_parent - id of the parent group
+   * @param name - path of the dataset to be written
+   * @param rhs - data to be written
+   * @param options - compression options
+   * @return id of newly created dataset
+   */
+  template <typename T>
+  hid_t create_compressed_dataset(hid_t root_parent, const std::string& name, const T& rhs, const compression_options& options) {
+    static_assert(is_1D_array<T> || is_ND_array<T>, "Only arrays can be written in compressed chunks");
+    // chunks are raw copies of array memory, so elements should not own any data
+    static_assert(is_scalar<internal::element_type_t<const T>>, "Only arrays of scalar types can be written in compressed chunks");
+    internal::create_parents(root_parent, name);
+    auto [rank, int_dims] = internal::extract_dataset_shape(rhs);
+    if (rank == 0) {
+      throw hdf5_create_dataset_error("Can not create compressed dataset " + name + " for rank-0 data");
+    }
+    hid_t                  type_id   = internal::get_type_id(rhs);
+    size_t                 elem_size = H5Tget_size(type_id);
+    size_t                 row_size  = std::accumulate(int_dims.begin() + 1, int_dims.end(), 1ul, std::multiplies<>());
+    internal::chunk_layout layout{int_dims[0], row_size * elem_size, options.chunk_rows, elem_size, size_t(rank)};
+    if (layout.chunk_rows == 0) layout.chunk_rows = std::max<size_t>(1, (1ul << 20) / std::max<size_t>(1, layout.row_bytes));
+    layout.chunk_rows = std::max<size_t>(1, std::min(layout.chunk_rows, layout.rows));
+    std::vector<hsize_t> dims(int_dims.begin(), int_dims.end());
+    std::vector<hsize_t> chunk(dims);
+    chunk[0] = layout.chunk_rows;
+    for (auto& c : chunk) c = std::max<hsize_t>(c, 1);
+    hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    if (H5Pset_chunk(dcpl, rank, chunk.data()) < 0 || (options.shuffle && H5Pset_shuffle(dcpl) < 0) ||
+        H5Pset_deflate(dcpl, options.level) < 0) {
+      H5Pclose(dcpl);
+      throw hdf5_create_dataset_error("Can not set compression options for dataset " + name);
+    }
+    hid_t dataspace_id = H5Screate_simple(rank, dims.data(), NULL);
+    hid_t d_id         = H5Dcreate2(root_parent, name.c_str(), type_id, dataspace_id, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    H5Sclose(dataspace_id);
+    H5Pclose(dcpl);
+    if (d_id == H5I_INVALID_HID) {
+      throw hdf5_create_dataset_error("Can not create dataset " + name);
+    }
+    try {
+      internal::write_chunks(d_id, name, reinterpret_cast<const char*>(rhs.data()), layout, options);
+    } catch (...) {
+      // partially written dataset is not left in the file
+      H5Dclose(d_id);
+      H5Ldelete(root_parent, name.c_str(), H5P_DEFAULT);
+      throw;
+    }
+    return d_id;
+  }
+
+  /**
+   * Read chunked compressed dataset into `rhs'. If the dataset layout allows it, compressed chunks are read directly from
+   * the file and decompressed in parallel, otherwise the dataset is read by HDF5 as usual.
+   *
+   * @tparam T - type of target data
+   * @param current_id - id of dataset to be read
+   * @param path - absolute path to dataset (needed for error message)
+   * @param rhs - target data container
+   * @param threads - number of decompression threads, 0 to use all available hardware threads
+   */
+  template <typename T>
+  void read_compressed_dataset(hid_t current_id, const std::string& path, T& rhs, size_t threads = 0) {
+    static_assert(is_1D_array<T> || is_ND_array<T>, "Only arrays can be read in compressed chunks");
+    static_assert(is_scalar<internal::element_type_t<T>>, "Only arrays of scalar types can be read in compressed chunks");
+    internal::chunk_layout layout;
+    bool                   shuffle;
+    auto                   shape = internal::dataset_dims(current_id);
+    size_t                 size  = internal::shape_size(shape);
+    bool                   matches;
+    if constexpr (is_ND_array<T>) {
+      matches = internal::same_shape(shape, rhs.shape());
+      if constexpr (is_resizable_nd<T>) {
+        if (!matches) rhs.resize(std::vector<size_t>(shape.begin(), shape.end()));
+        matches = true;
+      }
+    } else {
+      matches = size_t(rhs.size()) == size;
+      if constexpr (is_resizable<T>) {
+        if (!matches) rhs.resize(size);
+        matches = true;
+      }
+    }
+    // fall back to the regular read, it will report shape mismatch if needed
+    if (!matches || size == 0 || !internal::direct_chunk_layout(current_id, internal::get_type_id(rhs), layout, shuffle)) {
+      read_dataset(current_id, path, rhs);
+      return;
+    }
+    internal::read_chunks(current_id, path, reinterpret_cast<char*>(rhs.data()), layout, shuffle, threads);
+  }
+
+}  // namespace green::h5pp
+
+#endif  // H5PP_COMPRESSION_H
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#ifndef H5PP_DEDUP_H
+#define H5PP_DEDUP_H
+
+#include <cstdio>
+#include <vector>
+
+#include "blocks.h"
+#include "common.h"
+
+namespace green::h5pp {
+
+  template <typename T>
+  constexpr bool is_deduplicable = (is_1D_array<T> || is_ND_array<T>) &&
+                                   !std::is_same_v<std::remove_cv_t<std::remove_reference_t<T>>, std::vector<std::string>>;
+
+  namespace internal {
+    // group that holds hard links to deduplicated datasets, named by hexadecimal content hash
+    inline constexpr const char* dedup_index_group = "/.h5pp_dedup";
+
+    inline std::string dedup_key(uint64_t hash) {
+      char key[17];
+      std::snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+      return key;
+    }
+
+    /**
+     * Compare `count' elements of `lhs' and `rhs' bytewise. Elements of compound types are compared member by member, so
+     * that struct padding does not affect the result, consistently with `content_hash'.
+     */
+    template <typename E>
+    bool same_elements(const E* lhs, const E* rhs, size_t count) {
+      if constexpr (is_compound_scalar<E>) {
+        std::string lhs_members, rhs_members;
+        for (size_t i = 0; i < count; ++i) {
+          lhs_members.clear();
+          rhs_members.clear();
+          pack_members(lhs[i], lhs_members);
+          pack_members(rhs[i], rhs_members);
+          if (lhs_members != rhs_members) return false;
+        }
+        return true;
+      } else {
+        return count == 0 || std::memcmp(lhs, rhs, count * sizeof(E)) == 0;
+      }
+    }
+
+    /**
+     * Check that dataset `d_id' has the same type, shape and content as `rhs'. Dataset is read in blocks of bounded size.
+     *
+     * @param d_id - id of the indexed dataset
+     * @param path - path of the indexed dataset (needed for error message)
+     * @param rhs - data to be compared
+     */
+    template <typename T>
+    bool same_content(hid_t d_id, const std::string& path, const T& rhs) {
+      using E            = std::remove_cv_t<std::remove_reference_t<decltype(*rhs.data())>>;
+      hid_t file_type_id = H5Dget_type(d_id);
+      bool  same         = H5Tequal(file_type_id, get_type_id(rhs)) > 0;
+      H5Tclose(file_type_id);
+      auto [rank, dims] = extract_dataset_shape(rhs);
+      if (!same || !same_shape(dims, dataset_dims(d_id))) return false;
+      // blocks along the leading axis are consecutive parts of the dataset in row-major order
+      try {
+        block_range<E> blocks(d_id, path);
+        const E*       data = rhs.data();
+        for (const auto& block : blocks) {
+          if (!same_elements(block.view.data(), data, block.view.size())) return false;
+          data += block.view.size();
+        }
+      } catch (const std::runtime_error&) {
+        // dataset that can not be read is not used as a duplicate
+        return false;
+      }
+      return true;
+    }
+
+    /**
+     * @return index key of dataset `d_id' or empty string if dataset is not registered in the deduplication index
+     */
+    inline std::string indexed_key(hid_t d_id) {
+      if (!attribute_exists(d_id, dedup_key_attribute)) return {};
+      std::string key;
+      read_attribute(d_id, dedup_key_attribute, key);
+      // attribute may outlive the index entry, e.g. if dataset was copied, so the entry should point to the same object
+      std::string entry = std::string(dedup_index_group) + "/" + key;
+      hdf5_info_t info, entry_info;
+      if (H5Lexists(d_id, dedup_index_group, H5P_DEFAULT) <= 0 || H5Lexists(d_id, entry.c_str(), H5P_DEFAULT) <= 0 ||
+          H5Oget_info2(d_id, &info, H5O_INFO_BASIC) < 0 ||
+          H5Oget_info_by_name2(d_id, entry.c_str(), &entry_info, H5O_INFO_BASIC, H5P_DEFAULT) < 0 ||
+          info.addr != entry_info.addr) {
+        return {};
+      }
+      return key;
+    }
+
+    /**
+     * @return `true' if object `obj_id' is reachable by more than one hard link, link from the deduplication index is not
+     * counted
+     */
+    inline bool is_shared_object(hid_t obj_id) {
+      hdf5_info_t info;
+      if (H5Oget_info2(obj_id, &info, H5O_INFO_BASIC) < 0) return false;
+      return info.rc > (info.rc > 1 && !indexed_key(obj_id).empty() ? 2u : 1u);
+    }
+
+    /**
+     * Register dataset `name' in the deduplication index under `key' unless the key is already taken.
+     */
+    inline void register_deduplicated(hid_t root_parent, hid_t d_id, const std::string& name, const std::string& key) {
+      hid_t  index_id = create_group(root_parent, dedup_index_group);
+      herr_t status   = 0;
+      if (H5Lexists(index_id, key.c_str(), H5P_DEFAULT) <= 0) {
+        status = H5Lcreate_hard(root_parent, name.c_str(), index_id, key.c_str(), H5P_DEFAULT, H5P_DEFAULT);
+        if (status >= 0) write_attribute(d_id, dedup_key_attribute, key);
+      }
+      H5Gclose(index_id);
+      if (status < 0) {
+        throw hdf5_create_dataset_error("Can not register dataset " + name + " in deduplication index");
+      }
+    }
+
+    /**
+     * Remove dataset `d_id' from the deduplication index before its content is changed. Stale entry would otherwise keep
+     * the old content alive and shadow datasets with the same hash.
+     *
+     * @return `true' if dataset was registered in the index
+     */
+    inline bool unregister_deduplicated(hid_t d_id) {
+      std::string key = indexed_key(d_id);
+      if (key.empty()) return false;
+      std::string entry = std::string(dedup_index_group) + "/" + key;
+      if (H5Ldelete(d_id, entry.c_str(), H5P_DEFAULT) < 0 || H5Adelete(d_id, dedup_key_attribute) < 0) {
+        throw hdf5_write_error("Can not remove dataset from deduplication index");
+      }
+      return true;
+    }
+
+    /**
+     * @return `true' if the deduplication index contains a dataset with the same type, shape and content as `rhs' under `key'
+     */
+    template <typename T>
+    bool has_deduplicated(hid_t root_parent, const std::string& key, const T& rhs) {
+      std::string entry = std::string(dedup_index_group) + "/" + key;
+      if (H5Lexists(root_parent, dedup_index_group, H5P_DEFAULT) <= 0 || H5Lexists(root_parent, entry.c_str(), H5P_DEFAULT) <= 0) {
+        return false;
+      }
+      hid_t d_id = H5Dopen2(root_parent, entry.c_str(), H5P_DEFAULT);
+      if (d_id == H5I_INVALID_HID) return false;
+      bool same = same_content(d_id, entry, rhs);
+      H5Dclose(d_id);
+      return same;
+    }
+  }  // namespace internal
+
+  /**
+   * Create dataset at `name' path for array `rhs' unless the file already contains a dataset with identical content. Datasets
+   * are looked up by content hash in the index group `/.h5pp_dedup', candidate is compared block by block and on match a hard
+   * link to it is created instead of new storage. Otherwise new dataset is created and registered in the index.
+   *
+   * @tparam T - type of the data to be written
+   * @param root_parent - id of the parent group
+   * @param name - path of the dataset to be written
+   * @param rhs - data to be written
+   * @param resizable - create resizable dataset if new storage is needed
+   * @return id of the new or shared dataset
+   */
+  template <typename T>
+  hid_t create_deduplicated_dataset(hid_t root_parent, const std::string& name, const T& rhs, bool resizable = false) {
+    static_assert(is_deduplicable<T>, "Only arrays of scalar types can be deduplicated");
+    std::string key      = internal::dedup_key(internal::content_hash(rhs));
+    hid_t       index_id = create_group(root_parent, internal::dedup_index_group);
+    if (H5Lexists(index_id, key.c_str(), H5P_DEFAULT) > 0) {
+      hid_t d_id = H5Dopen2(index_id, key.c_str(), H5P_DEFAULT);
+      if (d_id != H5I_INVALID_HID && internal::same_content(d_id, std::string(internal::dedup_index_group) + "/" + key, rhs)) {
+        internal::create_parents(root_parent, name);
+        herr_t status = H5Lcreate_hard(index_id, key.c_str(), root_parent, name.c_str(), H5P_DEFAULT, H5P_DEFAULT);
+        H5Gclose(index_id);
+        if (status < 0) {
+          H5Dclose(d_id);
+          throw hdf5_create_dataset_error("Can not link deduplicated dataset " + name);
+        }
+        return d_id;
+      }
+      if (d_id != H5I_INVALID_HID) H5Dclose(d_id);
+      // hash collision, data is stored separately and the existing index entry is kept
+      H5Gclose(index_id);
+      return create_dataset(root_parent, name, rhs, resizable);
+    }
+    H5Gclose(index_id);
+    hid_t d_id = create_dataset(root_parent, name, rhs, resizable);
+    try {
+      internal::register_deduplicated(root_parent, d_id, name, key);
+    } catch (...) {
+      H5Dclose(d_id);
+      throw;
+    }
+    return d_id;
+  }
+
+}  // namespace green::h5pp
+
+#endif  // H5PP_DEDUP_H
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#ifndef H5PP_EXECUTOR_H
+#define H5PP_EXECUTOR_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "archive.h"
+
+namespace green::h5pp {
+
+  /**
+   * I/O executor owns an archive and performs all HDF5 calls on a single dedicated thread. Any number of compute threads can
+   * submit read and write requests concurrently and obtain std::future for the result. Requests are executed in the order
+   * they were submitted. All requests that are pending at the moment executor thread wakes up are taken from the queue at once,
+   * so that lock handoff is amortized over the whole batch.
+   *
+   * Archive should not be accessed outside of the executor while executor is alive.
+   */
+  class io_executor {
+  public:
+    /**
+     * Open file `filename' and start executor thread.
+     *
+     * @param filename - name of the file
+     * @param access_type - file access type, see `archive::open'
+     * @param options - additional file access options
+     */
+    io_executor(const std::string& filename, const std::string& access_type = "r", const access_options& options = {});
+
+    /**
+     * Execute all pending requests, stop executor thread and close the file.
+     */
+    ~io_executor();
+
+    io_executor(const io_executor&)            = delete;
+    io_executor& operator=(const io_executor&) = delete;
+
+    /**
+     * Submit generic request to the executor. Callable will be executed on the executor thread with a reference to
+     * the underlying archive.
+     *
+     * @tparam F - type of the callable, should be invocable with `archive&'
+     * @param f - request to be executed
+     * @return future for the result of the request, exceptions thrown by request are stored in the future
+     */
+    template <typename F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<F, archive&>> {
+      using R   = std::invoke_result_t<F, archive&>;
+      auto task = std::make_shared<std::packaged_task<R()>>([this, f = std::forward<F>(f)]() mutable { return f(_archive); });
+      std::future<R> result = task->get_future();
+      enqueue([task]() { (*task)(); });
+      return result;
+    }
+
+    /**
+     * Write `data' into dataset `path'. Data is moved (or copied) into the request, so the source can be reused right away.
+     *
+     * @tparam T - type of the data
+     * @param path - path to the dataset
+     * @param data - data to be written
+     * @return future that becomes ready once data is written
+     */
+    template <typename T>
+    std::future<void> write(const std::string& path, T data) {
+      return submit([path, data = std::move(data)](archive& ar) { ar[path] << data; });
+    }
+
+    /**
+     * Read dataset `path' into `data'. Target container should not be accessed until returned future becomes ready.
+     *
+     * @tparam T - type of the target container
+     * @param path - path to the dataset
+     * @param data - target container
+     * @return future that becomes ready once data is read
+     */
+    template <typename T>
+    std::future<void> read(const std::string& path, T& data) {
+      return submit([path, &data](archive& ar) { ar[path] >> data; });
+    }
+
+    /**
+     * Read dataset `path' into new object of type `T'
+     *
+     * @tparam T - type of the data
+     * @param path - path to the dataset
+     * @return future for the read data
+     */
+    template <typename T>
+    std::future<T> read(const std::string& path) {
+      return submit([path](archive& ar) {
+        T data;
+        ar[path] >> data;
+        return data;
+      });
+    }
+
+    /**
+     * Block until all requests submitted so far are executed.
+     */
+    void wait();
+
+  private:
+    void                               enqueue(std::function<void()>&& request);
+    void                               run();
+
+    archive                            _archive;
+    std::mutex                         _mutex;
+    std::condition_variable            _condition;
+    std::vector<std::function<void()>> _queue;
+    bool                               _stop;
+    std::thread                        _thread;
+  };
+
+}  // namespace green::h5pp
+
+#endif  // H5PP_EXECUTOR_H
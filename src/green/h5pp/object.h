@@ -7,93 +7,182 @@
 #define H5PP_OBJECT_H
 
 #include <iostream>
+#include <list>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 
+#include "array_view.h"
+#include "block_sparse.h"
+#include "buffer.h"
 #include "common.h"
+#include "compression.h"
+#include "dedup.h"
+#include "reduce.h"
 
 namespace green::h5pp {
 
   enum object_type { FILE, DATASET, GROUP, UNDEFINED, INVALID };
 
+  namespace internal {
+    /**
+     * HDF5 identifier of a group or dataset shared between copies of `object'. Identifier is obtained lazily, when the object
+     * is accessed for the first time, and is closed when the last copy is destroyed. Lazy resolution modifies the shared
+     * handle from `const' methods without synchronization, so copies of an object, as any other HDF5 objects, should not be
+     * used from several threads concurrently, see `io_executor' for multithreaded access.
+     */
+    struct object_handle {
+      hid_t                              id       = H5I_INVALID_HID;
+      object_type                        type     = INVALID;
+      bool                               resolved = true;
+      // path of the parent group that should be created before the object is resolved for write
+      std::shared_ptr<const std::string> parent;
+      // handle is kept in archive handle cache, dataset metadata is kept between reads
+      bool                               cached = false;
+      std::unique_ptr<dataset_metadata>  metadata;
+
+      object_handle()                                = default;
+      object_handle(const object_handle&)            = delete;
+      object_handle& operator=(const object_handle&) = delete;
+      // handle that was not closed by the last object, e.g. evicted from the cache
+      ~object_handle() {
+        if (id != H5I_INVALID_HID && (type == GROUP || type == DATASET)) H5Oclose(id);
+      }
+    };
+
+    /**
+     * LRU cache of open dataset handles keyed by absolute path. Cache is shared between archive and objects obtained from it.
+     */
+    class handle_cache {
+    public:
+      explicit handle_cache(size_t capacity) : _capacity(capacity) {}
+
+      /**
+       * @return cached handle for `path' or nullptr, found entry becomes the most recently used one
+       */
+      std::shared_ptr<object_handle> find(const std::string& path) {
+        auto it = _index.find(path);
+        if (it == _index.end()) return nullptr;
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return it->second->second;
+      }
+
+      /**
+       * Insert `handle' for `path', least recently used entries are evicted when capacity is exceeded
+       */
+      void insert(const std::string& path, std::shared_ptr<object_handle> handle) {
+        erase(path);
+        handle->cached = true;
+        _entries.emplace_front(path, std::move(handle));
+        _index.emplace(_entries.front().first, _entries.begin());
+        while (_entries.size() > _capacity) drop(std::prev(_entries.end()));
+      }
+
+      void erase(const std::string& path) {
+        auto it = _index.find(path);
+        if (it != _index.end()) drop(it->second);
+      }
+
+      void clear() {
+        while (!_entries.empty()) drop(_entries.begin());
+      }
+
+      size_t size() const { return _entries.size(); }
+
+    private:
+      using entry = std::pair<std::string, std::shared_ptr<object_handle>>;
+      size_t                                                           _capacity;
+      std::list<entry>                                                 _entries;
+      // keys point into strings owned by `_entries'
+      std::unordered_map<std::string_view, std::list<entry>::iterator> _index;
+
+      // handle that leaves the cache may still be used by objects, its metadata is no longer kept up to date
+      void                                                             drop(std::list<entry>::iterator entry) {
+        entry->second->cached = false;
+        entry->second->metadata.reset();
+        _index.erase(entry->first);
+        _entries.erase(entry);
+      }
+    };
+  }  // namespace internal
+
   class object {
   public:
     /**
      * Default constructor for H5 object set all ids to H5I_INVALID_HID
      */
-    object() : _file_id(H5I_INVALID_HID), _current_id(H5I_INVALID_HID), _path(""), _type(INVALID), _readonly(false) {}
+    object() :
+        _file_id(H5I_INVALID_HID), _handle(std::make_shared<internal::object_handle>()),
+        _path(std::make_shared<const std::string>()), _readonly(false) {}
     /**
-     * Copy-constructor. We open new H5 obejct at the specific path to avoid multiple release of the same resource
+     * Copy-constructor. Underlying H5 object is shared between copies, no HDF5 calls are made.
      * @param rhs - object to make copy from
      */
     object(const object& rhs) :
-        _file_id(rhs._file_id), _current_id(H5I_INVALID_HID), _path(rhs._path), _type(rhs._type), _readonly(rhs._readonly) {
-      _current_id = H5Oopen(_file_id, _path.c_str(), H5P_DEFAULT);
-    }
+        _file_id(rhs._file_id), _handle(rhs._handle), _path(rhs._path), _readonly(rhs._readonly), _overwrite(rhs._overwrite),
+        _intern_paths(rhs._intern_paths), _track_changes(rhs._track_changes), _deduplicate(rhs._deduplicate),
+        _cache(rhs._cache) {}
     /**
-     * Move constructor. We make sure that we invalidate source ids
+     * Move constructor. We make sure that we invalidate source ids, source object is left with `INVALID' type
      * @param rhs - object to be moved
      */
     object(object&& rhs) :
-        _file_id(rhs._file_id), _current_id(rhs._current_id), _path(rhs._path), _type(rhs._type), _readonly(rhs._readonly) {
-      rhs._file_id    = H5I_INVALID_HID;
-      rhs._current_id = H5I_INVALID_HID;
+        _file_id(rhs._file_id), _handle(std::exchange(rhs._handle, std::make_shared<internal::object_handle>())),
+        _path(rhs._path), _readonly(rhs._readonly),
+        _overwrite(rhs._overwrite), _intern_paths(rhs._intern_paths), _track_changes(rhs._track_changes),
+        _deduplicate(rhs._deduplicate), _cache(std::move(rhs._cache)) {
+      rhs._file_id = H5I_INVALID_HID;
     }
     /**
-     * Copy-assignment. Similar to constructor we open new object with specific path. We make sure to release current
-     * resources if they have valid H5 id
+     * Copy-assignment. Underlying H5 object of `rhs' is shared, current H5 object is released if this was the last reference.
      *
      * @param rhs - object to make copy from
      * @return reference to current object
      */
     object& operator=(const object& rhs) {
       if (&rhs == this) return *this;
-      if (_current_id != H5I_INVALID_HID) {
-        if (H5Oclose(_current_id) < 0)
-          throw hdf5_object_close_error("Can not close "s + (_type == DATASET ? "dataset" : "group") + " " + _path);
-      }
-      _file_id    = rhs._file_id;
-      _current_id = H5Oopen(_file_id, rhs._path.c_str(), H5P_DEFAULT);
-      _path       = rhs._path;
-      _type       = rhs._type;
-      _readonly   = rhs._readonly;
+      release(true);
+      _file_id       = rhs._file_id;
+      _handle        = rhs._handle;
+      _path          = rhs._path;
+      _readonly      = rhs._readonly;
+      _overwrite     = rhs._overwrite;
+      _intern_paths  = rhs._intern_paths;
+      _track_changes = rhs._track_changes;
+      _deduplicate   = rhs._deduplicate;
+      _cache         = rhs._cache;
       return *this;
     }
     /**
-     * Move assignment. Source object is invalidated. We make sure to release current resources if they have valid H5 id.
+     * Move assignment. Source object is invalidated. Current H5 object is released if this was the last reference.
      *
      * @param rhs - object to be moved
      * @return reference to current object
      */
     object& operator=(object&& rhs) {
       if (&rhs == this) return *this;
-      if (_current_id != H5I_INVALID_HID) {
-        if (H5Oclose(_current_id) < 0)
-          throw hdf5_object_close_error("Can not close "s + (_type == DATASET ? "dataset" : "group") + " " + _path);
-      }
-      // Transfer ownership of H5 object
-      _current_id     = rhs._current_id;
-      _file_id        = rhs._file_id;
-      _path           = rhs._path;
-      _type           = rhs._type;
-      _readonly       = rhs._readonly;
-      rhs._current_id = H5I_INVALID_HID;
-      rhs._file_id    = H5I_INVALID_HID;
+      release(true);
+      // Transfer ownership of H5 object, source is left with an invalid handle
+      _handle        = std::exchange(rhs._handle, std::make_shared<internal::object_handle>());
+      _file_id       = rhs._file_id;
+      _path          = rhs._path;
+      _readonly      = rhs._readonly;
+      _overwrite     = rhs._overwrite;
+      _intern_paths  = rhs._intern_paths;
+      _track_changes = rhs._track_changes;
+      _deduplicate   = rhs._deduplicate;
+      _cache         = std::move(rhs._cache);
+      rhs._file_id   = H5I_INVALID_HID;
       return *this;
     }
 
     /**
-     * Check if the object id is valid and close it. This only close dataset and group, file is closed in it's own destructor.
+     * Release reference to the H5 object and close it if this was the last one. This only close dataset and group, file is
+     * closed in it's own destructor.
      */
-    virtual ~object() noexcept(false) {
-      if (_current_id == H5I_INVALID_HID) {
-        return;
-      }
-      if (_type == INVALID || _type == FILE) {
-        return;
-      }
-      if (H5Oclose(_current_id) < 0)
-        throw hdf5_object_close_error("Can not close "s + (_type == DATASET ? "dataset" : "group") + " " + _path);
-    }
+    virtual ~object() noexcept(false) { release(); }
 
     /**
      * Construct object with specific file_id, path and type
@@ -104,7 +193,7 @@ namespace green::h5pp {
      * @param is_readonly - set to be read-only
      */
     object(hid_t file_id, const std::string& opath, object_type otype, bool is_readonly) :
-        _file_id(file_id), _path(opath), _type(otype), _readonly(is_readonly) {}
+        object(file_id, H5I_INVALID_HID, opath, otype, is_readonly) {}
 
     /**
      * Construct object for specific H5 id and with specific file_id, path and type
@@ -116,7 +205,23 @@ namespace green::h5pp {
      * @param is_readonly - set to be read-only
      */
     object(hid_t file_id, hid_t current_id, const std::string& opath, object_type otype, bool is_readonly) :
-        _file_id(file_id), _current_id(current_id), _path(opath), _type(otype), _readonly(is_readonly) {}
+        object(file_id, current_id, std::make_shared<const std::string>(opath), otype, is_readonly) {}
+
+    /**
+     * Construct object for specific H5 id and with specific file_id, shared path and type
+     *
+     * @param file_id - id of the file
+     * @param current_id - id of a current group or dataset
+     * @param opath - shared path to the object
+     * @param otype - type of the object
+     * @param is_readonly - set to be read-only
+     */
+    object(hid_t file_id, hid_t current_id, std::shared_ptr<const std::string> opath, object_type otype, bool is_readonly) :
+        _file_id(file_id), _handle(std::make_shared<internal::object_handle>()), _path(std::move(opath)),
+        _readonly(is_readonly) {
+      _handle->id   = current_id;
+      _handle->type = otype;
+    }
 
     /**
      * Create object for specific parent object.
@@ -128,66 +233,89 @@ namespace green::h5pp {
      * @param is_readonly - set to be read-only
      */
     object(hid_t file_id, hid_t parent_id, const std::string& path, const std::string& root_path, bool is_readonly) :
-        _file_id(file_id), _current_id(H5I_INVALID_HID), _path(root_path + "/" + path), _type(INVALID), _readonly(is_readonly) {
+        object(file_id, parent_id, path, std::make_shared<const std::string>(utils::join_path(root_path, path)), is_readonly) {}
+
+    /**
+     * Create object for specific parent object with already built absolute path.
+     *
+     * @param file_id - id of the file
+     * @param parent_id - id of the parent object
+     * @param path - relative path of the object, should be a path to a valid group or dataset
+     * @param full_path - shared absolute path of the object
+     * @param is_readonly - set to be read-only
+     */
+    object(hid_t file_id, hid_t parent_id, const std::string& path, std::shared_ptr<const std::string> full_path,
+           bool is_readonly) : object(file_id, H5I_INVALID_HID, std::move(full_path), INVALID, is_readonly) {
       hdf5_info_t oinfo;
       H5Oget_info_by_name2(parent_id, path.c_str(), &oinfo, H5O_INFO_BASIC, H5P_DEFAULT);
       switch (oinfo.type) {
         case H5O_TYPE_GROUP:
-          _type       = GROUP;
-          _current_id = H5Gopen2(parent_id, path.c_str(), H5P_DEFAULT);
+          _handle->type = GROUP;
+          _handle->id   = H5Gopen2(parent_id, path.c_str(), H5P_DEFAULT);
           break;
         case H5O_TYPE_DATASET:
-          _type       = DATASET;
-          _current_id = H5Dopen2(parent_id, path.c_str(), H5P_DEFAULT);
+          _handle->type = DATASET;
+          _handle->id   = H5Dopen2(parent_id, path.c_str(), H5P_DEFAULT);
           break;
         default:
-          _type = INVALID;
+          _handle->type = INVALID;
       }
     }
 
     /**
      * Subscript operator. This operator can only be called on `FILE', `GROUP' or `UNDEFINED' object type.
      * New group will be created and object type will be set to `GROUP` if object type is undefined and file is not
-     * open for read-only. New H5 object with relative path `name' will be returned. If `name' is existing dataset or group path,
-     * the corresponding H5 object will be open. Object of `UNDEFINED' type will be returned otherwise.
+     * open for read-only. Object with relative path `name' will be returned, it is opened lazily on first access and will
+     * have `UNDEFINED' type if the path does not exist. Subscript of a writable object that has not been accessed yet makes
+     * no HDF5 calls, so chains like `ar["a"]["b"]["c"]' only touch the file when data is accessed. For read-only objects
+     * existence of the path is checked immediately.
      *
      * @param name - relative path to a group or dataset
      * @return group, dataset or undefined object for specific relative path
      */
     object operator[](const std::string& name) {
-      if (_type != GROUP && _type != FILE && !(!_readonly && _type == UNDEFINED)) {
-        throw hdf5_notsupported_error("Can not subscript.");
-      }
-      if (!_readonly && _type == UNDEFINED) {
-        _current_id = create_group(_file_id, _path);
-        _type       = GROUP;
+      auto path = child_path(name);
+      if (auto cached = cached_handle(*path)) return inherit(object(_file_id, std::move(cached), std::move(path), _readonly));
+      bool resolved = _handle->resolved;
+      if (resolved) {
+        auto& h = *_handle;
+        if (h.type != GROUP && h.type != FILE && !(!_readonly && h.type == UNDEFINED)) {
+          throw hdf5_notsupported_error("Can not subscript.");
+        }
+        if (!_readonly && h.type == UNDEFINED) {
+          h.id   = create_group(_file_id, *_path);
+          h.type = GROUP;
+        }
       }
-      htri_t info = H5LTpath_valid(_current_id, name.c_str(), true);
-      if (info == 0) {
-        if (_readonly) {
-          throw hdf5_wrong_path_error("No valid HDF5 object for path " + _path + "/" + name);
+      if (_readonly) {
+        htri_t info = resolved ? H5LTpath_valid(_handle->id, name.c_str(), true) : H5LTpath_valid(_file_id, path->c_str(), true);
+        if (info <= 0) {
+          throw hdf5_wrong_path_error("No valid HDF5 object for path " + *_path + "/" + name);
         }
-        return object(_file_id, H5I_INVALID_HID, _path + "/" + name, UNDEFINED, _readonly);
       }
-      return object(_file_id, _current_id, name, _path, _readonly);
+      // unresolved parent is created together with the child
+      return inherit(object(_file_id, std::move(path), resolved || _readonly ? nullptr : _path, _readonly));
     }
 
     /**
      * Constant version of subscript operator. Check if the current object is valid `FILE' or `GROUP' and that `name' corresponds
-     * to a valid realtive path in current file. Valid H5 object will be returned.
+     * to a valid realtive path in current file. Object is opened lazily on first access.
      *
      * @param name - relative path to a group or dataset
      * @return valid group or dataset object for specific relative path
      */
     object operator[](const std::string& name) const {
-      if (_type != GROUP && _type != FILE) {
+      auto path = child_path(name);
+      if (auto cached = cached_handle(*path)) return inherit(object(_file_id, std::move(cached), std::move(path), _readonly));
+      auto& h = handle();
+      if (h.type != GROUP && h.type != FILE) {
         throw hdf5_notsupported_error("Only File or Group can subscripted.");
       }
-      htri_t info = H5LTpath_valid(_current_id, name.c_str(), true);
-      if (info == 0) {
-        throw hdf5_wrong_path_error("No valid HDF5 object for path " + _path + "/" + name);
+      htri_t info = H5LTpath_valid(h.id, name.c_str(), true);
+      if (info <= 0) {
+        throw hdf5_wrong_path_error("No valid HDF5 object for path " + *_path + "/" + name);
       }
-      return object(_file_id, _current_id, name, _path, _readonly);
+      return inherit(object(_file_id, std::move(path), nullptr, _readonly));
     }
 
     /**
@@ -199,13 +327,29 @@ namespace green::h5pp {
      */
     template <typename T>
     object& operator>>(T&& rhs) {
-      if (_type != DATASET) {
-        throw hdf5_not_a_dataset_error(_path + " is not a dataset");
+      if constexpr (is_sparse<T> || is_block_sparse<T>) {
+        if (handle().type != GROUP) {
+          throw hdf5_read_error(*_path + " is not a sparse matrix");
+        }
+        read_sparse(handle().id, *_path, rhs);
+        return *this;
+      }
+      if (handle().type != DATASET) {
+        throw hdf5_not_a_dataset_error(*_path + " is not a dataset");
       }
       if constexpr (is_scalar<T> || is_1D_array<T> || is_ND_array<T>) {
-        read_dataset(_current_id, _path, rhs);
+        auto& h = handle();
+        if (h.cached) {
+          // cached handles are not used with SWMR, so the dataset does not need to be refreshed
+          if (!h.metadata) h.metadata = std::make_unique<internal::dataset_metadata>(h.id);
+          read_dataset(h.id, *_path, rhs, *h.metadata);
+        } else {
+          refresh_dataset(_file_id, h.id);
+          read_dataset(h.id, *_path, rhs);
+        }
       } else if constexpr (is_string<T>) {
-        read_string_dataset(_current_id, _path, rhs);
+        refresh_dataset(_file_id, handle().id);
+        read_string_dataset(handle().id, *_path, rhs);
       } else {
         throw hdf5_unsupported_type_error("Type "s + typeid(T).name() + " is not supported in current implementation"s);
       }
@@ -221,11 +365,110 @@ namespace green::h5pp {
      */
     template <typename T>
     object& operator>>(T* rhs) {
-      if (_type != DATASET) {
-        throw hdf5_not_a_dataset_error(_path + " is not a dataset");
+      if (handle().type != DATASET) {
+        throw hdf5_not_a_dataset_error(*_path + " is not a dataset");
+      }
+      refresh_dataset(_file_id, handle().id);
+      if constexpr (is_scalar<T>) {
+        read_dataset(handle().id, *_path, rhs);
+      } else {
+        throw hdf5_unsupported_type_error("Type "s + typeid(T).name() + " is not supported in current implementation"s);
+      }
+      return *this;
+    }
+
+    /**
+     * Read `count' rows of the current sparse matrix starting from row `first'. Only non-zero elements of the requested
+     * rows are read, row indices of the result are relative to `first'.
+     *
+     * @tparam T - type of sparse matrix
+     * @param first - first row to be read
+     * @param count - number of rows to be read
+     * @param rhs - target sparse matrix
+     * @return current object to chain reading.
+     */
+    template <typename T>
+    object& read_rows(size_t first, size_t count, T& rhs) {
+      static_assert(is_sparse<T>, "Only sparse matrices can be read by rows");
+      if (handle().type != GROUP) {
+        throw hdf5_read_error(*_path + " is not a sparse matrix");
+      }
+      read_sparse_rows(handle().id, *_path, first, count, rhs);
+      return *this;
+    }
+
+    /**
+     * Read a single block with key `key' of the current block-sparse tensor. Only values of the requested block are read.
+     *
+     * @tparam T - type of the target array
+     * @param key - key of the block
+     * @param rhs - target array, resized to the block shape if possible
+     * @return current object to chain reading.
+     */
+    template <typename T>
+    object& read_block(int64_t key, T& rhs) {
+      if (handle().type != GROUP) {
+        throw hdf5_read_error(*_path + " is not a block-sparse tensor");
+      }
+      read_sparse_block(handle().id, *_path, key, rhs);
+      return *this;
+    }
+
+    /**
+     * Read single field `field' of the current compound dataset into `rhs'.
+     *
+     * @tparam T - type of target data, scalar or array with elements of the field type
+     * @param field - name of the field
+     * @param rhs - target data container
+     * @return current object to chain reading.
+     */
+    template <typename T>
+    object& read_field(const std::string& field, T&& rhs) {
+      if (handle().type != DATASET) {
+        throw hdf5_not_a_dataset_error(*_path + " is not a dataset");
+      }
+      refresh_dataset(_file_id, handle().id);
+      if constexpr (is_scalar<T> || is_1D_array<T> || is_ND_array<T>) {
+        read_compound_field(handle().id, *_path, field, rhs);
+      } else {
+        throw hdf5_unsupported_type_error("Type "s + typeid(T).name() + " is not supported in current implementation"s);
+      }
+      return *this;
+    }
+
+    /**
+     * Read current dataset into a new owning buffer. Memory is obtained from `alloc', so data is read directly into the
+     * storage used by compute kernels, e.g. 64-byte aligned memory (default) or an arena.
+     *
+     * @tparam T - type of elements in memory
+     * @tparam Allocator - allocator type
+     * @param alloc - allocator instance
+     * @return buffer with the data and the shape of the dataset
+     */
+    template <typename T, typename Allocator = aligned_allocator<T>>
+    ndbuffer<T, Allocator> read(const Allocator& alloc = Allocator()) {
+      ndbuffer<T, Allocator> result(alloc);
+      *this >> result;
+      return result;
+    }
+
+    /**
+     * Read hyperslab of the current dataset into a contiguous buffer pointed by `rhs'. Check that object is dataset.
+     *
+     * @tparam T - type of variable
+     * @param offset - starting point of the hyperslab
+     * @param count - number of elements in each dimension of the hyperslab
+     * @param rhs - pointer to a buffer to read data into
+     * @return current object to chain reading.
+     */
+    template <typename T>
+    object& read_hyperslab(const std::vector<size_t>& offset, const std::vector<size_t>& count, T* rhs) {
+      if (handle().type != DATASET) {
+        throw hdf5_not_a_dataset_error(*_path + " is not a dataset");
       }
+      refresh_dataset(_file_id, handle().id);
       if constexpr (is_scalar<T>) {
-        read_dataset(_current_id, _path, rhs);
+        h5pp::read_hyperslab(handle().id, *_path, offset, count, rhs);
       } else {
         throw hdf5_unsupported_type_error("Type "s + typeid(T).name() + " is not supported in current implementation"s);
       }
@@ -234,7 +477,8 @@ namespace green::h5pp {
 
     /**
      * Write `rhs' into current dataset. If object has `UNDEFINED' type new dataset will be created.
-     * Data will be overwritten if dataset already exists and source and target shape matching.
+     * Data will be overwritten if dataset already exists and source and target shape matching. If shapes are different,
+     * behavior is defined by the overwrite policy of the object, see `set_overwrite_policy'.
      *
      * @tparam T - type of data to be written
      * @param rhs - data to be written
@@ -245,29 +489,327 @@ namespace green::h5pp {
       if (_readonly) {
         throw hdf5_write_error("Can not write into readonly object");
       }
-      if (_type != DATASET && _type != UNDEFINED) {
-        throw std::runtime_error(_path + " is not dataset");
+      if constexpr (is_sparse<T> || is_block_sparse<T>) {
+        // sparse matrix is stored as a group, previous matrix is replaced since number of non-zeros may change
+        if (handle().type == GROUP && sparse_format(handle().id).empty()) {
+          throw hdf5_write_error(*_path + " is not a sparse matrix");
+        }
+        if (handle().type != GROUP && handle().type != UNDEFINED) {
+          throw hdf5_write_error(*_path + " is not a sparse matrix");
+        }
+        if (handle().type == GROUP) {
+          H5Oclose(handle().id);
+          handle().id = H5I_INVALID_HID;
+          invalidate_cache(true);
+          if (H5Ldelete(_file_id, _path->c_str(), H5P_DEFAULT) < 0) {
+            throw hdf5_write_error("Can not unlink sparse matrix " + *_path);
+          }
+        }
+        handle().id   = write_sparse(_file_id, *_path, rhs);
+        handle().type = GROUP;
+        return *this;
       }
-      if (_type == UNDEFINED) {
-        if constexpr (is_scalar<T> || is_1D_array<T> || is_ND_array<T> || is_string<T>) {
-          _current_id = create_dataset(_file_id, _path, rhs);
+      if (handle().type != DATASET && handle().type != UNDEFINED) {
+        throw std::runtime_error(*_path + " is not dataset");
+      }
+      uint64_t hash = 0;
+      if constexpr (is_scalar<T> || is_1D_array<T> || is_ND_array<T> || is_string<T>) {
+        if (_track_changes) {
+          hash = internal::content_hash(rhs);
+          if (handle().type == DATASET && stored_hash_matches(hash)) return *this;
+        }
+      }
+      std::string index_key;
+      if constexpr (is_deduplicable<T>) {
+        if (_deduplicate && handle().type == DATASET) {
+          bool shared = internal::is_shared_object(handle().id);
+          // old content of a dataset that is not shared is not needed anymore
+          if (!shared) unregister_deduplicated();
+          index_key = internal::dedup_key(internal::content_hash(rhs));
+          if (shared || internal::has_deduplicated(_file_id, index_key, rhs)) {
+            // dataset is replaced rather than updated in place, so that other links keep their content or the new content
+            // is shared with the already stored dataset
+            H5Oclose(handle().id);
+            handle().id   = H5I_INVALID_HID;
+            handle().type = UNDEFINED;
+            invalidate_cache(true);
+            index_key.clear();
+            if (H5Ldelete(_file_id, _path->c_str(), H5P_DEFAULT) < 0) {
+              throw hdf5_write_error("Can not unlink shared dataset " + *_path);
+            }
+          }
+        }
+      }
+      // index entry of a dataset that is updated in place would be stale
+      if (handle().type == DATASET && index_key.empty()) unregister_deduplicated();
+      if (!_track_changes && handle().type == DATASET) invalidate_hash();
+      if (handle().type == UNDEFINED) {
+        if constexpr (is_deduplicable<T>) {
+          handle().id = _deduplicate ? create_deduplicated_dataset(_file_id, *_path, rhs, _overwrite == RESIZE_OVERWRITE)
+                                     : create_dataset(_file_id, *_path, rhs, _overwrite == RESIZE_OVERWRITE);
+        } else if constexpr (is_scalar<T> || is_1D_array<T> || is_ND_array<T> || is_string<T>) {
+          handle().id = create_dataset(_file_id, *_path, rhs, _overwrite == RESIZE_OVERWRITE);
         } else {
           throw hdf5_unsupported_type_error("Type "s + typeid(T).name() + " is not supported in current implementation"s);
         }
       } else {
         if constexpr (is_scalar<T> || is_1D_array<T> || is_ND_array<T> || is_string<T>) {
-          write_dataset(_current_id, _path, rhs);
+          if (_overwrite == RESIZE_OVERWRITE) {
+            invalidate_cache();
+            handle().id = resize_and_write_dataset(_file_id, handle().id, *_path, rhs);
+          } else {
+            write_dataset(handle().id, *_path, rhs);
+          }
         } else {
           throw hdf5_unsupported_type_error("Type "s + typeid(T).name() + " is not supported in current implementation"s);
         }
       }
-      _type = DATASET;
+      handle().type = DATASET;
+      if (!index_key.empty()) internal::register_deduplicated(_file_id, handle().id, *_path, index_key);
+      if (_track_changes) write_attribute(handle().id, internal::content_hash_attribute, hash);
+      attributes_added(_track_changes, !index_key.empty());
+      return *this;
+    }
+
+    /**
+     * Write contiguous row-major array from caller memory into current dataset without copying it into a container.
+     * Dataset is created or updated the same way as with `operator<<'.
+     *
+     * @tparam T - type of array elements
+     * @param ptr - pointer to the first element
+     * @param shape - shape of the array
+     * @return current object to chain writting
+     */
+    template <typename T>
+    object& write(const T* ptr, const std::vector<size_t>& shape) {
+      static_assert(is_scalar<T>, "Only arrays of scalar types can be written from raw pointer");
+      return *this << array_view<const T>(ptr, shape);
+    }
+
+    /**
+     * Write array `rhs' into current dataset as a chunked compressed dataset. Chunks are compressed in parallel and written
+     * directly into the file, bypassing HDF5 filter pipeline. If object has `UNDEFINED' type new dataset will be created,
+     * existing dataset should have the same shape and a compatible chunked layout, e.g. created by previous `write_compressed'.
+     *
+     * @tparam T - type of data to be written
+     * @param rhs - data to be written
+     * @param options - compression options
+     * @return current object to chain writting
+     */
+    template <typename T>
+    object& write_compressed(const T& rhs, const compression_options& options = {}) {
+      if (_readonly) {
+        throw hdf5_write_error("Can not write into readonly object");
+      }
+      if (handle().type != DATASET && handle().type != UNDEFINED) {
+        throw hdf5_not_a_dataset_error(*_path + " is not a dataset");
+      }
+      if constexpr (is_1D_array<T> || is_ND_array<T>) {
+        static_assert(is_scalar<internal::element_type_t<const T>>, "Only arrays of scalar types can be written in compressed chunks");
+        if (handle().type == UNDEFINED) {
+          handle().id   = create_compressed_dataset(_file_id, *_path, rhs, options);
+          handle().type = DATASET;
+          return *this;
+        }
+        internal::chunk_layout layout;
+        bool                   shuffle;
+        auto [rank, int_dims] = internal::extract_dataset_shape(rhs);
+        if (!internal::same_shape(int_dims, internal::dataset_dims(handle().id)) ||
+            !internal::direct_chunk_layout(handle().id, internal::get_type_id(rhs), layout, shuffle)) {
+          throw hdf5_write_error("Dataset " + *_path + " is not compatible with compressed write");
+        }
+        invalidate_hash();
+        unregister_deduplicated();
+        compression_options dataset_options = options;
+        dataset_options.shuffle             = shuffle;
+        internal::write_chunks(handle().id, *_path, reinterpret_cast<const char*>(rhs.data()), layout, dataset_options);
+      } else {
+        throw hdf5_unsupported_type_error("Type "s + typeid(T).name() + " is not supported in current implementation"s);
+      }
+      return *this;
+    }
+
+    /**
+     * Read current compressed dataset into `rhs', decompressing chunks in parallel when dataset layout allows it.
+     *
+     * @tparam T - type of target data
+     * @param rhs - target data container
+     * @param threads - number of decompression threads, 0 to use all available hardware threads
+     */
+    template <typename T>
+    void read_compressed(T& rhs, size_t threads = 0) {
+      if (handle().type != DATASET) {
+        throw hdf5_not_a_dataset_error(*_path + " is not a dataset");
+      }
+      if constexpr (is_1D_array<T> || is_ND_array<T>) {
+        refresh_dataset(_file_id, handle().id);
+        read_compressed_dataset(handle().id, *_path, rhs, threads);
+      } else {
+        throw hdf5_unsupported_type_error("Type "s + typeid(T).name() + " is not supported in current implementation"s);
+      }
+    }
+
+    /**
+     * Range of consecutive blocks of the current dataset along axis `axis', read one at a time into a reused buffer. Block
+     * extent is chosen to fit `block_bytes' and aligned to chunk boundaries for chunked datasets. Slabs larger than
+     * `block_bytes' are split along the remaining axes, so a block exceeds the budget only if a single element does.
+     *
+     *     for (const auto& block : ar["data"].blocks<double>(0, 64ul << 20)) process(block.offset, block.view);
+     *
+     * @tparam T - type of elements in memory
+     * @param axis - axis to split the dataset along
+     * @param block_bytes - memory budget for a single block
+     * @return single-pass range of blocks
+     */
+    template <typename T = double>
+    block_range<T> blocks(size_t axis = 0, size_t block_bytes = internal::default_block_bytes) {
+      check_streamable();
+      return block_range<T>(handle().id, *_path, axis, block_bytes);
+    }
+
+    /**
+     * Sum of all elements of the current dataset. Dataset is streamed in chunk-aligned blocks, so memory usage is bounded
+     * by `block_bytes' regardless of the dataset size.
+     *
+     * @tparam T - type of elements in memory, also used for accumulation except for integers that are summed in 64 bits
+     * @param block_bytes - memory budget for a single block
+     * @return sum of elements
+     */
+    template <typename T = double>
+    internal::sum_type_t<T> sum(size_t block_bytes = internal::default_block_bytes) {
+      check_streamable();
+      return reduce_sum<T>(handle().id, *_path, block_bytes);
+    }
+
+    /**
+     * Smallest and largest elements of the current dataset, found in a single streaming pass. If any element is NaN,
+     * both results are NaN.
+     *
+     * @tparam T - type of elements in memory
+     * @param block_bytes - memory budget for a single block
+     * @return pair of the smallest and the largest elements
+     */
+    template <typename T = double>
+    std::pair<T, T> minmax(size_t block_bytes = internal::default_block_bytes) {
+      check_streamable();
+      return reduce_minmax<T>(handle().id, *_path, block_bytes);
+    }
+
+    /**
+     * Euclidean (Frobenius) norm of the current dataset computed by streaming.
+     *
+     * @tparam T - type of elements in memory, complex type for complex datasets
+     * @param block_bytes - memory budget for a single block
+     * @return norm of the dataset
+     */
+    template <typename T = double>
+    real_type_t<T> norm(size_t block_bytes = internal::default_block_bytes) {
+      check_streamable();
+      return reduce_norm<T>(handle().id, *_path, block_bytes);
+    }
+
+    /**
+     * Euclidean norm of the difference between the current dataset and dataset `other' of the same shape, e.g. for
+     * convergence checks between iterations stored on disk. Datasets can belong to different files.
+     *
+     * @tparam T - type of elements in memory, complex type for complex datasets
+     * @param other - dataset to compare with
+     * @param block_bytes - memory budget for a single block of both datasets
+     * @return norm of the difference
+     */
+    template <typename T = double>
+    real_type_t<T> diff_norm(const object& other, size_t block_bytes = internal::default_block_bytes) {
+      check_streamable();
+      other.check_streamable();
+      return reduce_diff_norm<T>(handle().id, *_path, other.handle().id, *other._path, block_bytes);
+    }
+
+    /**
+     * Euclidean norm of the difference between the current dataset and in-memory array `rhs' with the same number of
+     * elements, compared in row-major order.
+     *
+     * @tparam A - type of the array
+     * @param rhs - array to compare with
+     * @param block_bytes - memory budget for a single block
+     * @return norm of the difference
+     */
+    template <typename A>
+    std::enable_if_t<is_1D_array<A> || is_ND_array<A>, real_type_t<decltype(*std::declval<const A&>().data())>> diff_norm(
+        const A& rhs, size_t block_bytes = internal::default_block_bytes) {
+      check_streamable();
+      return reduce_diff_norm(handle().id, *_path, rhs, block_bytes);
+    }
+
+    /**
+     * Create virtual dataset for the current `UNDEFINED' object. Blocks of the virtual dataset are mapped to the source
+     * datasets, that can be located in other files. Reading from the virtual dataset with `operator>>' transparently
+     * reads data from the source datasets.
+     *
+     * @tparam T - type of dataset elements
+     * @param shape - shape of the virtual dataset
+     * @param sources - list of source datasets and their positions in the virtual dataset
+     * @return current object
+     */
+    template <typename T>
+    object& create_virtual(const std::vector<size_t>& shape, const std::vector<virtual_source>& sources) {
+      if (_readonly) {
+        throw hdf5_write_error("Can not write into readonly object");
+      }
+      if (handle().type != UNDEFINED) {
+        throw hdf5_create_dataset_error(*_path + " already exists");
+      }
+      handle().id   = create_virtual_dataset<T>(_file_id, *_path, shape, sources);
+      handle().type = DATASET;
+      return *this;
+    }
+
+    /**
+     * Append `rhs' as a new record to the current dataset. If object has `UNDEFINED' type new extendable dataset
+     * with a leading unlimited dimension will be created, each record has the shape of `rhs'.
+     *
+     * @tparam T - type of data to be appended
+     * @param rhs - record to be appended
+     * @return current object to chain writting
+     */
+    template <typename T>
+    object& append(const T& rhs) {
+      if (_readonly) {
+        throw hdf5_write_error("Can not write into readonly object");
+      }
+      if (handle().type != DATASET && handle().type != UNDEFINED) {
+        throw hdf5_not_a_dataset_error(*_path + " is not a dataset");
+      }
+      if constexpr (is_scalar<T> || is_1D_array<T> || is_ND_array<T>) {
+        if (handle().type == UNDEFINED) {
+          handle().id   = create_extendable_dataset(_file_id, *_path, rhs);
+          handle().type = DATASET;
+        } else {
+          invalidate_hash();
+          unregister_deduplicated();
+          invalidate_cache();
+        }
+        append_dataset(handle().id, *_path, rhs);
+      } else {
+        throw hdf5_unsupported_type_error("Type "s + typeid(T).name() + " is not supported in current implementation"s);
+      }
       return *this;
     }
 
+    /**
+     * Refresh metadata of the current dataset. Used by SWMR readers to observe data appended by the writer.
+     */
+    void refresh() {
+      if (handle().type != DATASET) {
+        throw hdf5_not_a_dataset_error(*_path + " is not a dataset");
+      }
+      if (H5Drefresh(handle().id) < 0) {
+        throw hdf5_read_error("Can not refresh dataset " + *_path);
+      }
+    }
+
     void move(const std::string& src_name, const std::string& dst_name) {
-      if (_type != GROUP && _type != FILE) {
-        throw hdf5_move_group_error(_path + " is not group or file");
+      if (handle().type != GROUP && handle().type != FILE) {
+        throw hdf5_move_group_error(*_path + " is not group or file");
       }
       if (_readonly) {
         throw hdf5_write_error("Can not move readonly object");
@@ -275,33 +817,163 @@ namespace green::h5pp {
       if (!has_group(src_name) && !is_data(src_name)) {
         throw hdf5_move_group_error("Source '" + src_name + "' is not found");
       }
-      move_group(_current_id, src_name, _current_id, dst_name);
+      invalidate_cache(true);
+      move_group(handle().id, src_name, handle().id, dst_name);
+    }
+
+    /**
+     * Remove link `name' from the current group or file. Cached handles are dropped, so that removed dataset can not be
+     * accessed by its old path. If the link was the last one to a deduplicated dataset, the dataset is also removed from the
+     * deduplication index, so its storage can be reclaimed. Deduplicated datasets inside removed groups stay in the index.
+     *
+     * @param name - path of the group or dataset relative to the current object
+     */
+    void unlink(const std::string& name) {
+      if (handle().type != GROUP && handle().type != FILE) {
+        throw hdf5_wrong_path_error(*_path + " is not group or file");
+      }
+      if (_readonly) {
+        throw hdf5_write_error("Can not unlink from readonly object");
+      }
+      if (!has_group(name) && !is_data(name)) {
+        throw hdf5_wrong_path_error("Object '" + name + "' is not found");
+      }
+      invalidate_cache(true);
+      if (is_data(name)) {
+        hid_t d_id = H5Dopen2(handle().id, name.c_str(), H5P_DEFAULT);
+        try {
+          if (!internal::is_shared_object(d_id)) internal::unregister_deduplicated(d_id);
+        } catch (...) {
+          H5Dclose(d_id);
+          throw;
+        }
+        H5Dclose(d_id);
+      }
+      if (H5Ldelete(handle().id, name.c_str(), H5P_DEFAULT) < 0) {
+        throw hdf5_write_error("Can not unlink '" + name + "' from " + *_path);
+      }
     }
 
+    /**
+     * Copy current group or dataset into `dst' object under relative path `name'. Objects can belong to different files.
+     * Raw data is copied directly by HDF5, without reading it into memory. If `dst' has `UNDEFINED' type new group
+     * will be created.
+     *
+     * @param dst - destination group or file
+     * @param name - path of the copy relative to `dst'
+     * @param options - copy options
+     */
+    void copy_to(object& dst, const std::string& name, const copy_options& options = {}) const {
+      if (handle().type != GROUP && handle().type != DATASET && handle().type != FILE) {
+        throw hdf5_copy_object_error(*_path + " is not a group or dataset");
+      }
+      if (dst._readonly) {
+        throw hdf5_write_error("Can not write into readonly object");
+      }
+      if (dst.handle().type != GROUP && dst.handle().type != FILE && dst.handle().type != UNDEFINED) {
+        throw hdf5_copy_object_error(*dst._path + " is not a group or file");
+      }
+      if (dst.handle().type == UNDEFINED) {
+        dst.handle().id   = create_group(dst._file_id, *dst._path);
+        dst.handle().type = GROUP;
+      }
+      copy_object(_file_id, *_path, dst.handle().id, name, options);
+    }
+
+    /**
+     * Copy current group or dataset into temporary `dst' object, e.g. `src.copy_to(ar["group"], "data")'
+     */
+    void copy_to(object&& dst, const std::string& name, const copy_options& options = {}) const { copy_to(dst, name, options); }
+
+    /**
+     * Set policy for updating existing datasets with data of a different shape. Objects obtained with subscript operator
+     * inherit the policy of their parent. With `RESIZE_OVERWRITE' every new dataset of non-zero rank is created chunked with
+     * unlimited maximal dimensions, so that it can be resized in place later, which affects its storage layout and the
+     * performance of reads by other applications.
+     *
+     * @param policy - new overwrite policy
+     */
+    void             set_overwrite_policy(overwrite_policy policy) { _overwrite = policy; }
+
+    /**
+     * @return current overwrite policy
+     */
+    overwrite_policy get_overwrite_policy() const { return _overwrite; }
+
+    /**
+     * Enable path interning for the current object and objects obtained from it with subscript operator. Absolute paths of
+     * child objects are then stored once in a process-wide table and shared between objects, so repeated access to the same
+     * path, e.g. `group["DATA"]' in a loop, does not build and allocate the path again. Interned paths are never released,
+     * so the option is intended for a bounded set of paths that are accessed many times.
+     *
+     * @param intern - `true' to enable interning
+     */
+    void set_path_interning(bool intern) {
+      if (intern && !_intern_paths) _path = intern_path(*_path);
+      _intern_paths = intern;
+    }
+
+    /**
+     * @return `true' if path interning is enabled
+     */
+    bool get_path_interning() const { return _intern_paths; }
+
+    /**
+     * Enable change tracking for the current object and objects obtained from it with subscript operator. Content hash of the
+     * data is computed on every `operator<<' and stored in `h5pp_hash' attribute of the dataset, writes of data whose hash
+     * matches the stored one are skipped. Writes without tracking, appends and compressed writes drop the stored hash.
+     *
+     * @param track - `true' to enable change tracking
+     */
+    void set_change_tracking(bool track) { _track_changes = track; }
+
+    /**
+     * @return `true' if change tracking is enabled
+     */
+    bool get_change_tracking() const { return _track_changes; }
+
+    /**
+     * Enable content deduplication for the current object and objects obtained from it with subscript operator. When a new
+     * array dataset is written, file is searched for a dataset with identical type, shape and content using content hash
+     * index stored in `/.h5pp_dedup' group. If such dataset exists, a hard link to it is created instead of new storage.
+     * Shared datasets are replaced rather than updated in place on subsequent writes with deduplication enabled, writes
+     * without deduplication modify all paths that share the dataset. Dataset that is changed, either in place or by
+     * replacement of its last link, is removed from the index, so old content does not stay in the file. Removal of the last
+     * link with `unlink' also removes the dataset from the index, links removed by other means leave the data in the index.
+     *
+     * @param deduplicate - `true' to enable deduplication
+     */
+    void set_deduplication(bool deduplicate) { _deduplicate = deduplicate; }
+
+    /**
+     * @return `true' if deduplication is enabled
+     */
+    bool get_deduplication() const { return _deduplicate; }
+
     /**
      * @return Absolute path to the object
      */
-    [[nodiscard]] const std::string& path() const { return _path; }
+    [[nodiscard]] const std::string& path() const { return *_path; }
 
     /**
      * @return type of the object
      */
-    object_type type() const { return _type; }
+    object_type type() const { return handle().type; }
 
     /**
      * @return `true' if group `group_name' exists
      */
     bool has_group(const std::string& group_name) const {
-      if (_current_id == H5I_INVALID_HID) return false;
-      return group_exists(_current_id, group_name[0] != '/' ? _path + "/" + group_name : group_name);
+      if (handle().id == H5I_INVALID_HID) return false;
+      return group_exists(handle().id, group_name[0] != '/' ? utils::join_path(*_path, group_name) : group_name);
     }
 
       /**
        * @return `true' if current object has attribute `name'
        */
       bool has_attribute(const std::string& attribute_name) const {
-        if (_current_id == H5I_INVALID_HID) return false;
-        return attribute_exists(_current_id, attribute_name);
+        if (handle().id == H5I_INVALID_HID) return false;
+        return attribute_exists(handle().id, attribute_name);
       }
 
       /**
@@ -314,7 +986,7 @@ namespace green::h5pp {
       template<typename T>
       T get_attribute(const std::string& attribute_name) const {
         T attribute_value;
-        read_attribute(_current_id, attribute_name, attribute_value);
+        read_attribute(handle().id, attribute_name, attribute_value);
         return attribute_value;
       }
 
@@ -330,22 +1002,22 @@ namespace green::h5pp {
         if (_readonly) {
           throw hdf5_write_error("Can not write into readonly object");
         }
-        write_attribute(_current_id, attribute_name, attribute_value);
+        write_attribute(handle().id, attribute_name, attribute_value);
       }
 
     /**
      * @return `true' if dataset `dataset_name' exists
      */
     bool is_data(const std::string& dataset_name) const {
-      if (_current_id == H5I_INVALID_HID) return false;
-      return dataset_exists(_current_id, dataset_name[0] != '/' ? _path + "/" + dataset_name : dataset_name);
+      if (handle().id == H5I_INVALID_HID) return false;
+      return dataset_exists(handle().id, dataset_name[0] != '/' ? utils::join_path(*_path, dataset_name) : dataset_name);
     }
 
     /**
      * Check if object state is valid
      * @return true if object is valid
      */
-    bool is_valid() const { return _file_id != H5I_INVALID_HID || _current_id != H5I_INVALID_HID; }
+    bool is_valid() const { return _file_id != H5I_INVALID_HID || (_handle && handle().id != H5I_INVALID_HID); }
 
     /**
      * @return current file HDF5 descriptor
@@ -358,22 +1030,203 @@ namespace green::h5pp {
     /**
      * @return current object HDF5 identifier
      */
-    hid_t& current_id() { return _current_id; }
+    hid_t& current_id() { return handle().id; }
     /**
      * @return current object HDF5 identifier
      */
-    hid_t current_id() const { return _current_id; }
+    hid_t current_id() const { return handle().id; }
 
   protected:
-    bool& readonly() { return _readonly; }
-    bool  readonly() const { return _readonly; }
+    bool&                                    readonly() { return _readonly; }
+    bool                                     readonly() const { return _readonly; }
+    std::shared_ptr<internal::handle_cache>& handle_cache() { return _cache; }
 
   private:
-    hid_t       _file_id;
-    hid_t       _current_id;
-    std::string _path;
-    object_type _type;
-    bool        _readonly;
+    /**
+     * Create object for absolute path `opath' that will be opened on first access
+     *
+     * @param file_id - id of the file
+     * @param opath - shared absolute path of the object
+     * @param parent - path of the parent group to be created on first access, if any
+     * @param is_readonly - set to be read-only
+     */
+    object(hid_t file_id, std::shared_ptr<const std::string> opath, std::shared_ptr<const std::string> parent, bool is_readonly) :
+        object(file_id, H5I_INVALID_HID, std::move(opath), INVALID, is_readonly) {
+      _handle->resolved = false;
+      _handle->parent   = std::move(parent);
+    }
+
+    /**
+     * Create object for absolute path `opath' that shares existing handle
+     */
+    object(hid_t file_id, std::shared_ptr<internal::object_handle> handle, std::shared_ptr<const std::string> opath,
+           bool is_readonly) : _file_id(file_id), _handle(std::move(handle)), _path(std::move(opath)), _readonly(is_readonly) {}
+
+    /**
+     * @return open dataset handle for absolute path `path' from the handle cache, nullptr if there is none
+     */
+    std::shared_ptr<internal::object_handle> cached_handle(const std::string& path) const {
+      return _cache ? _cache->find(path) : nullptr;
+    }
+
+    /**
+     * Drop cached metadata of the current dataset. Cached handle of the same path is dropped if it is not shared with this
+     * object, since its metadata may be outdated.
+     *
+     * @param all - drop all cached handles, used when links are removed or renamed
+     */
+    void invalidate_cache(bool all = false) {
+      if (_handle) _handle->metadata.reset();
+      if (!_cache) return;
+      if (all) {
+        _cache->clear();
+      } else if (auto cached = _cache->find(*_path); cached && cached != _handle) {
+        _cache->erase(*_path);
+      }
+    }
+
+    /**
+     * @return shared H5 object, opened if it has not been accessed yet
+     */
+    internal::object_handle& handle() const {
+      if (!_handle->resolved) resolve();
+      return *_handle;
+    }
+
+    void resolve() const {
+      auto& h    = *_handle;
+      h.resolved = true;
+      if (h.parent) {
+        auto parent = std::move(h.parent);
+        if (dataset_exists(_file_id, *parent)) {
+          throw hdf5_notsupported_error("Can not subscript.");
+        }
+        H5Gclose(create_group(_file_id, *parent));
+      }
+      if (H5LTpath_valid(_file_id, _path->c_str(), true) <= 0) {
+        if (_readonly) {
+          throw hdf5_wrong_path_error("No valid HDF5 object for path " + *_path);
+        }
+        h.type = UNDEFINED;
+        return;
+      }
+      hdf5_info_t oinfo;
+      H5Oget_info_by_name2(_file_id, _path->c_str(), &oinfo, H5O_INFO_BASIC, H5P_DEFAULT);
+      switch (oinfo.type) {
+        case H5O_TYPE_GROUP:
+          h.type = GROUP;
+          h.id   = H5Gopen2(_file_id, _path->c_str(), H5P_DEFAULT);
+          break;
+        case H5O_TYPE_DATASET:
+          h.type = DATASET;
+          h.id   = H5Dopen2(_file_id, _path->c_str(), H5P_DEFAULT);
+          if (_cache && h.id != H5I_INVALID_HID) _cache->insert(*_path, _handle);
+          break;
+        default:
+          h.type = INVALID;
+      }
+    }
+
+    /**
+     * Drop reference to the shared H5 object and close it if this was the last reference. Reference is kept if the object
+     * can not be closed.
+     *
+     * @param any_type - close any valid id, otherwise only groups and datasets are closed
+     */
+    void release(bool any_type = false) {
+      if (_handle && _handle.use_count() == 1) {
+        auto& h = *_handle;
+        if (h.id != H5I_INVALID_HID && (any_type || (h.type != INVALID && h.type != FILE))) {
+          if (H5Oclose(h.id) < 0)
+            throw hdf5_object_close_error("Can not close "s + (h.type == DATASET ? "dataset" : "group") + " " + *_path);
+          h.id = H5I_INVALID_HID;
+        }
+      }
+      _handle.reset();
+    }
+
+    object inherit(object&& child) const {
+      child._overwrite     = _overwrite;
+      child._intern_paths  = _intern_paths;
+      child._track_changes = _track_changes;
+      child._deduplicate   = _deduplicate;
+      child._cache         = _cache;
+      return std::move(child);
+    }
+
+    void check_streamable() const {
+      if (handle().type != DATASET) {
+        throw hdf5_not_a_dataset_error(*_path + " is not a dataset");
+      }
+      refresh_dataset(_file_id, handle().id);
+    }
+
+    /**
+     * @return metadata of the current dataset if its handle is cached, nullptr otherwise
+     */
+    internal::dataset_metadata* cached_metadata() const {
+      auto& h = handle();
+      if (!h.cached) return nullptr;
+      if (!h.metadata) h.metadata = std::make_unique<internal::dataset_metadata>(h.id);
+      return h.metadata.get();
+    }
+
+    /**
+     * Record that content hash or deduplication key attributes were added to the current dataset. Cached handle of the same
+     * path that is not shared with this object is dropped, since its record of the attributes would be outdated.
+     */
+    void attributes_added(bool hash, bool dedup_key) {
+      if (!hash && !dedup_key) return;
+      if (auto* metadata = cached_metadata()) {
+        metadata->has_hash      = metadata->has_hash || hash;
+        metadata->has_dedup_key = metadata->has_dedup_key || dedup_key;
+      } else {
+        invalidate_cache();
+      }
+    }
+
+    bool stored_hash_matches(uint64_t hash) const {
+      if (auto* metadata = cached_metadata(); metadata && !metadata->has_hash) return false;
+      if (!attribute_exists(handle().id, internal::content_hash_attribute)) return false;
+      uint64_t stored;
+      read_attribute(handle().id, internal::content_hash_attribute, stored);
+      return stored == hash;
+    }
+
+    void invalidate_hash() {
+      auto* metadata = cached_metadata();
+      if (metadata && !metadata->has_hash) return;
+      if (attribute_exists(handle().id, internal::content_hash_attribute) &&
+          H5Adelete(handle().id, internal::content_hash_attribute) < 0) {
+        throw hdf5_write_error("Can not remove content hash of " + *_path);
+      }
+      if (metadata) metadata->has_hash = false;
+    }
+
+    /**
+     * Remove the current dataset from the deduplication index before its content is changed
+     */
+    void unregister_deduplicated() {
+      auto* metadata = cached_metadata();
+      if (metadata && !metadata->has_dedup_key) return;
+      internal::unregister_deduplicated(handle().id);
+      if (metadata) metadata->has_dedup_key = false;
+    }
+
+    std::shared_ptr<const std::string> child_path(const std::string& name) const {
+      if (_intern_paths) return intern_path(_path, name);
+      return std::make_shared<const std::string>(utils::join_path(*_path, name));
+    }
+
+    hid_t                                    _file_id;
+    std::shared_ptr<internal::object_handle> _handle;
+    std::shared_ptr<const std::string>       _path;
+    bool                                     _readonly;
+    overwrite_policy                         _overwrite     = STRICT_OVERWRITE;
+    bool                                     _intern_paths  = false;
+    bool                                     _track_changes = false;
+    bool                                     _deduplicate   = false;
+    std::shared_ptr<internal::handle_cache>  _cache;
   };
 }  // namespace green::h5pp
 #endif  // H5PP_OBJECT_H
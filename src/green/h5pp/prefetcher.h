@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#ifndef H5PP_PREFETCHER_H
+#define H5PP_PREFETCHER_H
+
+#include "array_view.h"
+#include "executor.h"
+
+namespace green::h5pp {
+
+  /**
+   * Sequential reader of dataset slabs along a chosen axis with read-ahead. Next `lookahead' slabs are read asynchronously
+   * by the I/O executor into a ring of reusable buffers while the caller works on the current slab, so that I/O overlaps
+   * with computations.
+   *
+   * View returned by `next' remains valid until the following call to `next'.
+   *
+   * @tparam T - type of dataset elements in memory
+   */
+  template <typename T>
+  class slab_prefetcher {
+  public:
+    /**
+     * Create prefetcher for dataset `path' and start reading first slabs.
+     *
+     * @param executor - I/O executor that owns the file
+     * @param path - path to the dataset
+     * @param lookahead - number of slabs to be read ahead of the current one
+     * @param axis - dataset axis to iterate over
+     */
+    slab_prefetcher(io_executor& executor, const std::string& path, size_t lookahead = 1, size_t axis = 0) :
+        _executor(executor), _path(path), _axis(axis), _current(0), _buffers(lookahead + 1), _pending(lookahead + 1) {
+      _shape = _executor.submit([path](archive& ar) { return dataset_shape(ar.current_id(), path); }).get();
+      if (_axis >= _shape.size()) {
+        throw hdf5_read_error("Dataset " + path + " does not have axis " + std::to_string(_axis));
+      }
+      _slab_shape = _shape;
+      _slab_shape.erase(_slab_shape.begin() + _axis);
+      size_t slab_size = std::accumulate(_slab_shape.begin(), _slab_shape.end(), 1ul, std::multiplies<>());
+      for (auto& buffer : _buffers) buffer.resize(slab_size);
+      for (size_t k = 0; k < std::min(_buffers.size(), size()); ++k) schedule(k);
+    }
+
+    /**
+     * Wait for all pending reads, since they refer to the internal buffers
+     */
+    ~slab_prefetcher() {
+      for (auto& pending : _pending) {
+        if (pending.valid()) pending.wait();
+      }
+    }
+
+    slab_prefetcher(const slab_prefetcher&)            = delete;
+    slab_prefetcher& operator=(const slab_prefetcher&) = delete;
+
+    /**
+     * @return total number of slabs along the chosen axis
+     */
+    size_t                     size() const { return _shape[_axis]; }
+
+    /**
+     * @return shape of a single slab
+     */
+    const std::vector<size_t>& slab_shape() const { return _slab_shape; }
+
+    /**
+     * @return `true' if there are slabs that have not been returned yet
+     */
+    bool                       has_next() const { return _current < size(); }
+
+    /**
+     * Return next slab. Buffer of the previously returned slab is reused for the read-ahead of the upcoming slab.
+     * Exceptions that happen during the read are rethrown here, the slab that could not be read is skipped, so iteration
+     * can be continued with the following slabs.
+     *
+     * @return view of the next slab
+     */
+    array_view<const T> next() {
+      if (!has_next()) {
+        throw hdf5_read_error("No more slabs in dataset " + _path);
+      }
+      // previous slab is released by the caller, reuse its buffer
+      if (_current > 0 && _current - 1 + _buffers.size() < size()) schedule(_current - 1 + _buffers.size());
+      size_t slot = _current % _buffers.size();
+      // future is consumed by `get', slab is counted as returned before a read error is rethrown
+      ++_current;
+      _pending[slot].get();
+      return array_view<const T>(_buffers[slot].data(), _slab_shape);
+    }
+
+  private:
+    void schedule(size_t k) {
+      std::vector<size_t> offset(_shape.size(), 0);
+      std::vector<size_t> count(_shape);
+      offset[_axis] = k;
+      count[_axis]  = 1;
+      T* buffer     = _buffers[k % _buffers.size()].data();
+      _pending[k % _buffers.size()] =
+          _executor.submit([path = _path, offset, count, buffer](archive& ar) { ar[path].read_hyperslab(offset, count, buffer); });
+    }
+
+    io_executor&                   _executor;
+    std::string                    _path;
+    size_t                         _axis;
+    size_t                         _current;
+    std::vector<size_t>            _shape;
+    std::vector<size_t>            _slab_shape;
+    std::vector<std::vector<T>>    _buffers;
+    std::vector<std::future<void>> _pending;
+  };
+
+}  // namespace green::h5pp
+
+#endif  // H5PP_PREFETCHER_H
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#ifndef H5PP_REDUCE_H
+#define H5PP_REDUCE_H
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#include "blocks.h"
+
+namespace green::h5pp {
+
+  namespace internal {
+    /**
+     * Accumulate `term(i)' for i in [0, n) in several independent lanes, which breaks the dependency chain of the
+     * accumulator and lets the compiler vectorize the loop without changing the floating-point semantics.
+     */
+    template <typename R, typename F>
+    R accumulate_lanes(size_t n, F&& term) {
+      R      acc[4] = {R(0), R(0), R(0), R(0)};
+      size_t i      = 0;
+      for (; i + 4 <= n; i += 4) {
+        acc[0] += term(i);
+        acc[1] += term(i + 1);
+        acc[2] += term(i + 2);
+        acc[3] += term(i + 3);
+      }
+      for (; i < n; ++i) acc[0] += term(i);
+      return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    }
+
+    // integers are accumulated in 64-bit types, so that sums of narrow types do not overflow
+    template <typename T>
+    using sum_type_t = std::conditional_t<std::is_integral_v<T>, std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>, T>;
+
+    /**
+     * @return squared absolute value of `x'
+     */
+    template <typename T>
+    real_type_t<T> abs2(const T& x) {
+      if constexpr (is_complex_scalar<T>) {
+        return x.real() * x.real() + x.imag() * x.imag();
+      } else {
+        return x * x;
+      }
+    }
+  }  // namespace internal
+
+  /**
+   * Sum of all elements of dataset `d_id'. Dataset is read in blocks of at most `block_bytes' bytes.
+   *
+   * @tparam T - type of elements in memory, also used for accumulation of floating-point and complex elements, integers
+   * are accumulated in 64-bit integers
+   * @param d_id - id of the dataset
+   * @param path - absolute path to dataset (needed for error message)
+   * @param block_bytes - memory budget for a single block
+   * @return sum of elements
+   */
+  template <typename T>
+  internal::sum_type_t<T> reduce_sum(hid_t d_id, const std::string& path, size_t block_bytes = internal::default_block_bytes) {
+    static_assert(std::is_arithmetic_v<T> || is_complex_scalar<T>, "Only arithmetic and complex datasets can be reduced");
+    using S = internal::sum_type_t<T>;
+    S result(0);
+    for (const auto& block : block_range<T>(d_id, path, 0, block_bytes)) {
+      const T* x = block.view.data();
+      result += internal::accumulate_lanes<S>(block.view.size(), [x](size_t i) { return S(x[i]); });
+    }
+    return result;
+  }
+
+  /**
+   * Smallest and largest elements of dataset `d_id', found in a single pass over the dataset. NaN is propagated: if any
+   * element is NaN, both results are NaN.
+   *
+   * @tparam T - type of elements in memory
+   * @param d_id - id of the dataset
+   * @param path - absolute path to dataset (needed for error message)
+   * @param block_bytes - memory budget for a single block
+   * @return pair of the smallest and the largest elements
+   */
+  template <typename T>
+  std::pair<T, T> reduce_minmax(hid_t d_id, const std::string& path, size_t block_bytes = internal::default_block_bytes) {
+    static_assert(std::is_arithmetic_v<T>, "Only datasets of real types can be ordered");
+    T    lo{};
+    T    hi{};
+    bool empty = true;
+    bool nan   = false;
+    for (const auto& block : block_range<T>(d_id, path, 0, block_bytes)) {
+      const T* x = block.view.data();
+      size_t   n = block.view.size();
+      if (n == 0) continue;
+      if (empty) {
+        lo    = x[0];
+        hi    = x[0];
+        empty = false;
+      }
+      for (size_t i = 0; i < n; ++i) {
+        // comparisons with NaN are false, so NaNs are skipped here and reported separately
+        lo = x[i] < lo ? x[i] : lo;
+        hi = x[i] > hi ? x[i] : hi;
+        if constexpr (std::is_floating_point_v<T>) nan |= x[i] != x[i];
+      }
+    }
+    if (empty) {
+      throw hdf5_read_error("Dataset " + path + " is empty");
+    }
+    if (nan) return {std::numeric_limits<T>::quiet_NaN(), std::numeric_limits<T>::quiet_NaN()};
+    return {lo, hi};
+  }
+
+  /**
+   * Euclidean (Frobenius) norm of dataset `d_id'.
+   *
+   * @tparam T - type of elements in memory
+   * @param d_id - id of the dataset
+   * @param path - absolute path to dataset (needed for error message)
+   * @param block_bytes - memory budget for a single block
+   * @return square root of the sum of squared absolute values of elements
+   */
+  template <typename T>
+  real_type_t<T> reduce_norm(hid_t d_id, const std::string& path, size_t block_bytes = internal::default_block_bytes) {
+    static_assert(std::is_arithmetic_v<T> || is_complex_scalar<T>, "Only arithmetic and complex datasets can be reduced");
+    using R = real_type_t<T>;
+    R result(0);
+    for (const auto& block : block_range<T>(d_id, path, 0, block_bytes)) {
+      const T* x = block.view.data();
+      result += internal::accumulate_lanes<R>(block.view.size(), [x](size_t i) { return internal::abs2(x[i]); });
+    }
+    return std::sqrt(result);
+  }
+
+  /**
+   * Euclidean norm of the difference of datasets `d_id' and `other_id' of the same shape. Both datasets are read in
+   * blocks of matching records, memory budget is shared between them.
+   *
+   * @tparam T - type of elements in memory
+   * @param d_id - id of the dataset
+   * @param path - absolute path to dataset (needed for error message)
+   * @param other_id - id of the other dataset
+   * @param other_path - absolute path to the other dataset (needed for error message)
+   * @param block_bytes - memory budget for a single block of both datasets
+   * @return norm of the difference
+   */
+  template <typename T>
+  real_type_t<T> reduce_diff_norm(hid_t d_id, const std::string& path, hid_t other_id, const std::string& other_path,
+                                  size_t block_bytes = internal::default_block_bytes) {
+    static_assert(std::is_arithmetic_v<T> || is_complex_scalar<T>, "Only arithmetic and complex datasets can be reduced");
+    using R = real_type_t<T>;
+    // both datasets are read with the same blocking, aligned to the chunks of the first one
+    block_range<T> blocks(d_id, path, 0, block_bytes / 2);
+    auto           other_dims = internal::dataset_dims(other_id);
+    if (blocks.shape() != std::vector<size_t>(other_dims.begin(), other_dims.end())) {
+      throw hdf5_read_error("Datasets " + path + " and " + other_path + " have different shapes");
+    }
+    block_range<T> other(other_id, other_path, 0, 0, blocks.block_shape());
+    R    result(0);
+    auto other_block = other.begin();
+    for (const auto& block : blocks) {
+      const T* x = block.view.data();
+      const T* y = other_block->view.data();
+      result += internal::accumulate_lanes<R>(block.view.size(), [x, y](size_t i) { return internal::abs2(x[i] - y[i]); });
+      ++other_block;
+    }
+    return std::sqrt(result);
+  }
+
+  /**
+   * Euclidean norm of the difference of dataset `d_id' and in-memory array `rhs' with the same number of elements.
+   * Elements are compared in row-major order.
+   *
+   * @tparam A - type of the array
+   * @param d_id - id of the dataset
+   * @param path - absolute path to dataset (needed for error message)
+   * @param rhs - array to compare with
+   * @param block_bytes - memory budget for a single block
+   * @return norm of the difference
+   */
+  template <typename A>
+  auto reduce_diff_norm(hid_t d_id, const std::string& path, const A& rhs, size_t block_bytes = internal::default_block_bytes) {
+    static_assert(is_1D_array<A> || is_ND_array<A>, "Dataset can only be compared with an array");
+    using T = std::remove_cv_t<std::remove_reference_t<decltype(*rhs.data())>>;
+    static_assert(std::is_arithmetic_v<T> || is_complex_scalar<T>, "Only arithmetic and complex datasets can be reduced");
+    using R = real_type_t<T>;
+    block_range<T> blocks(d_id, path, 0, block_bytes);
+    if (internal::shape_size(blocks.shape()) != size_t(rhs.size())) {
+      throw hdf5_read_error("Size of dataset " + path + " does not match size of the array");
+    }
+    R        result(0);
+    const T* y = rhs.data();
+    for (const auto& block : blocks) {
+      const T* x = block.view.data();
+      size_t   n = block.view.size();
+      result += internal::accumulate_lanes<R>(n, [x, y](size_t i) { return internal::abs2(x[i] - y[i]); });
+      y += n;
+    }
+    return std::sqrt(result);
+  }
+
+}  // namespace green::h5pp
+
+#endif  // H5PP_REDUCE_H
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#ifndef H5PP_SHAPE_H
+#define H5PP_SHAPE_H
+
+#include <hdf5.h>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <type_traits>
+
+#include "except.h"
+
+namespace green::h5pp::internal {
+
+  /**
+   * Fixed-capacity shape container stored in place, capacity is the maximal rank supported by HDF5.
+   * Used instead of std::vector for temporary shapes to avoid heap allocations on every read and write.
+   *
+   * @tparam Index - type of the shape elements
+   */
+  template <typename Index>
+  class shape_buffer {
+  public:
+    static constexpr size_t capacity = H5S_MAX_RANK;
+
+    shape_buffer() : _size(0) {}
+    explicit shape_buffer(size_t size, Index value = 0) : _size(0) { resize(size, value); }
+    template <typename Iterator, typename = std::enable_if_t<!std::is_integral_v<Iterator>>>
+    shape_buffer(Iterator first, Iterator last) : _size(0) {
+      resize(std::distance(first, last));
+      std::copy(first, last, _data.begin());
+    }
+
+    Index*       data() { return _data.data(); }
+    const Index* data() const { return _data.data(); }
+    size_t       size() const { return _size; }
+    Index*       begin() { return _data.data(); }
+    Index*       end() { return _data.data() + _size; }
+    const Index* begin() const { return _data.data(); }
+    const Index* end() const { return _data.data() + _size; }
+    Index&       operator[](size_t i) { return _data[i]; }
+    const Index& operator[](size_t i) const { return _data[i]; }
+
+    void         resize(size_t size, Index value = 0) {
+      if (size > capacity) {
+        throw hdf5_notsupported_error("Rank " + std::to_string(size) + " exceeds maximal rank supported by HDF5");
+      }
+      if (size > _size) std::fill(_data.begin() + _size, _data.begin() + size, value);
+      _size = size;
+    }
+
+    void push_back(Index value) {
+      resize(_size + 1);
+      _data[_size - 1] = value;
+    }
+
+  private:
+    std::array<Index, capacity> _data;
+    size_t                      _size;
+  };
+
+  // static_rank_t is a detector type for containers with std::array-like shape, e.g. T.shape() returns std::array<size_t, N>
+  template <typename T>
+  using static_rank_t = std::tuple_size<std::remove_cv_t<std::remove_reference_t<decltype(std::declval<const T&>().shape())>>>;
+
+  template <typename T, typename = void>
+  struct static_rank : std::integral_constant<int, -1> {};
+  template <typename T>
+  struct static_rank<T, std::void_t<decltype(static_rank_t<T>::value)>> : std::integral_constant<int, int(static_rank_t<T>::value)> {};
+
+  /**
+   * Compare two shapes of possibly different container and element types
+   */
+  template <typename A, typename B>
+  bool same_shape(const A& a, const B& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+  }
+
+  /**
+   * @return number of elements for a given shape
+   */
+  template <typename A>
+  size_t shape_size(const A& shape) {
+    return std::accumulate(shape.begin(), shape.end(), 1ul, std::multiplies<>());
+  }
+
+  /**
+   * Read dimensions of a dataspace into a fixed-capacity buffer
+   *
+   * @param space_id - dataspace id
+   * @param max_dims - optional buffer for maximal dimensions
+   * @return current dimensions of the dataspace
+   */
+  inline shape_buffer<hsize_t> dataspace_dims(hid_t space_id, shape_buffer<hsize_t>* max_dims = nullptr) {
+    int                   rank = H5Sget_simple_extent_ndims(space_id);
+    shape_buffer<hsize_t> dims(std::max(rank, 0));
+    if (max_dims != nullptr) max_dims->resize(dims.size());
+    H5Sget_simple_extent_dims(space_id, dims.data(), max_dims != nullptr ? max_dims->data() : NULL);
+    return dims;
+  }
+
+}  // namespace green::h5pp::internal
+
+#endif  // H5PP_SHAPE_H
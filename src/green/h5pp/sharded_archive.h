@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#ifndef H5PP_SHARDED_ARCHIVE_H
+#define H5PP_SHARDED_ARCHIVE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "archive.h"
+
+namespace green::h5pp {
+
+  /**
+   * Archive split into several HDF5 files (shards), so that data written by independent processes lands on different
+   * files and thus on different storage targets of a parallel file system.
+   *
+   * Top-level groups and datasets are placed into shards by a stable hash of their name, so every process finds the same
+   * shard for the same path without any coordination. Hash does not depend on the platform and the placement scheme is
+   * recorded in the manifest, so archives with a different placement are rejected on open. Small manifest file `filename' keeps the number and names of the
+   * shards, shards are stored next to it as `<stem>.shard<i><extension>'. Optionally the manifest can expose the content
+   * of all shards through external links, so that it can be read as a regular archive, see `link_shards'.
+   *
+   * Shards are opened on first access, so a process opens only the files it actually reads or writes. Files can not be
+   * open for write by several processes, therefore independent writers should write into top-level groups that are
+   * placed into different shards, e.g. by choosing the names with `shard_index'.
+   */
+  class sharded_archive {
+  public:
+    sharded_archive() = default;
+    /**
+     * Open sharded archive.
+     *
+     * @param filename - name of the manifest file
+     * @param access_type - access type, same as for `archive'
+     * @param shards - number of shards for new archive, ignored if existing archive is opened
+     * @param options - file access options used for all shards
+     */
+    sharded_archive(const std::string& filename, const std::string& access_type = "r", size_t shards = 0,
+                    const access_options& options = {});
+    ~sharded_archive();
+
+    sharded_archive(const sharded_archive&)            = delete;
+    sharded_archive& operator=(const sharded_archive&) = delete;
+
+    /**
+     * Open sharded archive. If new archive is created, manifest and all shards are created and existing files are
+     * truncated. Otherwise only manifest is read.
+     *
+     * @param filename - name of the manifest file
+     * @param access_type - access type, same as for `archive'
+     * @param shards - number of shards for new archive, ignored if existing archive is opened
+     * @param options - file access options used for all shards
+     */
+    void open(const std::string& filename, const std::string& access_type = "r", size_t shards = 0,
+              const access_options& options = {});
+
+    /**
+     * Close all opened shards
+     */
+    void close();
+
+    /**
+     * Flush all opened shards
+     */
+    void flush();
+
+    /**
+     * Object for path `path' in the shard that owns the top-level component of the path.
+     *
+     * @param path - path to a group or dataset, should not be empty
+     * @return group, dataset or undefined object for `path'
+     */
+    object                          operator[](const std::string& path);
+
+    bool                            is_data(const std::string& path) { return shard(shard_index(path)).is_data(path); }
+    bool                            has_group(const std::string& path) { return shard(shard_index(path)).has_group(path); }
+
+    /**
+     * @param path - path to a group or dataset
+     * @return index of the shard that stores `path'
+     */
+    size_t                          shard_index(const std::string& path) const;
+
+    /**
+     * @param i - index of the shard
+     * @return archive of the `i'-th shard, opened if it has not been accessed yet
+     */
+    archive&                        shard(size_t i);
+
+    /**
+     * @param i - index of the shard
+     * @return `true' if shard `i' is open
+     */
+    bool                            is_open(size_t i) const { return i < _shards.size() && _shards[i] != nullptr; }
+
+    /**
+     * @return number of shards
+     */
+    size_t                          size() const { return _shard_names.size(); }
+    const std::vector<std::string>& shard_names() const { return _shard_names; }
+    const std::string&              filename() const { return _filename; }
+
+    /**
+     * Create external links in the manifest for all top-level objects of all shards, so that the whole archive can be read
+     * through the manifest with a regular `archive' or any HDF5 tool. Links are resolved relative to the manifest
+     * directory. Should be called by a single process after all writers have finished, since manifest is open for write.
+     */
+    void                            link_shards();
+
+  private:
+    std::string                           _filename;
+    std::string                           _access_type;
+    access_options                        _options;
+    // shard file names relative to the manifest directory
+    std::vector<std::string>              _shard_names;
+    std::vector<std::unique_ptr<archive>> _shards;
+
+    std::string                           shard_path(size_t i) const;
+  };
+
+}  // namespace green::h5pp
+
+#endif  // H5PP_SHARDED_ARCHIVE_H
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#ifndef H5PP_SHARED_H
+#define H5PP_SHARED_H
+
+#include <mpi.h>
+
+#include <exception>
+#include <utility>
+#include <vector>
+
+#include "array_view.h"
+#include "object.h"
+
+namespace green::h5pp {
+
+  /**
+   * Read-only array that resides in an MPI-3 shared-memory window and is shared by all ranks of a node. Memory is owned
+   * by the node leader, other ranks access it directly through the window. Destruction is collective over the ranks of
+   * the communicator used to create the array.
+   *
+   * @tparam T - type of array elements
+   */
+  template <typename T>
+  class shared_array {
+  public:
+    shared_array() : _data(nullptr), _win(MPI_WIN_NULL), _node_comm(MPI_COMM_NULL) {}
+    shared_array(shared_array&& rhs) noexcept :
+        _data(rhs._data), _shape(std::move(rhs._shape)), _win(rhs._win), _node_comm(rhs._node_comm) {
+      rhs._data      = nullptr;
+      rhs._win       = MPI_WIN_NULL;
+      rhs._node_comm = MPI_COMM_NULL;
+    }
+    shared_array& operator=(shared_array&& rhs) noexcept {
+      std::swap(_data, rhs._data);
+      std::swap(_shape, rhs._shape);
+      std::swap(_win, rhs._win);
+      std::swap(_node_comm, rhs._node_comm);
+      return *this;
+    }
+    shared_array(const shared_array&)            = delete;
+    shared_array& operator=(const shared_array&) = delete;
+
+    ~shared_array() {
+      if (_win != MPI_WIN_NULL) MPI_Win_free(&_win);
+      if (_node_comm != MPI_COMM_NULL) MPI_Comm_free(&_node_comm);
+    }
+
+    const T*                   data() const { return _data; }
+    size_t                     size() const { return internal::shape_size(_shape); }
+    const std::vector<size_t>& shape() const { return _shape; }
+    array_view<const T>        view() const { return array_view<const T>(_data, _shape); }
+    const T&                   operator[](size_t i) const { return _data[i]; }
+    const T*                   begin() const { return _data; }
+    const T*                   end() const { return _data + size(); }
+
+    /**
+     * @return communicator of the ranks that share the array
+     */
+    MPI_Comm                   node_comm() const { return _node_comm; }
+
+  private:
+    const T*            _data;
+    std::vector<size_t> _shape;
+    MPI_Win             _win;
+    MPI_Comm            _node_comm;
+
+    template <typename U>
+    friend shared_array<U> read_shared(const object& dataset, MPI_Comm comm);
+  };
+
+  /**
+   * Read dataset into memory shared by all ranks of a node. Communicator `comm' is split into shared-memory nodes, on
+   * every node only the rank with the lowest rank in `comm' opens and reads the dataset into an MPI-3 shared-memory
+   * window, other ranks get a read-only view of it without reading the data. Memory usage and the volume of data read
+   * from the file system are thus independent of the number of ranks per node.
+   *
+   * Collective over `comm'. Other ranks still need the archive to be open to obtain `dataset', and for read-only archives
+   * subscript checks that the path exists, so every rank makes a few metadata requests. Since `dataset' is opened lazily,
+   * the dataset itself is not opened by the ranks that do not read.
+   *
+   *     auto integrals = read_shared<double>(ar["integrals/V"], MPI_COMM_WORLD);
+   *
+   * @tparam T - type of elements in memory
+   * @param dataset - dataset to be read
+   * @param comm - communicator of all ranks that need the data
+   * @return node-shared read-only array
+   */
+  template <typename T>
+  shared_array<T> read_shared(const object& dataset, MPI_Comm comm) {
+    static_assert(is_scalar<T>, "Only arrays of scalar types can be shared");
+    shared_array<T> result;
+    int             rank;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &result._node_comm);
+    int node_rank;
+    MPI_Comm_rank(result._node_comm, &node_rank);
+    bool leader = node_rank == 0;
+    // leader broadcasts the shape of the dataset, rank -1 reports failure
+    std::vector<unsigned long long> shape(H5S_MAX_RANK + 1, 0);
+    if (leader) {
+      try {
+        if (dataset.type() != DATASET) {
+          throw hdf5_not_a_dataset_error(dataset.path() + " is not a dataset");
+        }
+        auto dims = internal::dataset_dims(dataset.current_id());
+        shape[0]  = dims.size();
+        std::copy(dims.begin(), dims.end(), shape.begin() + 1);
+      } catch (...) {
+        shape[0] = -1ull;
+        MPI_Bcast(shape.data(), int(shape.size()), MPI_UNSIGNED_LONG_LONG, 0, result._node_comm);
+        throw;
+      }
+    }
+    MPI_Bcast(shape.data(), int(shape.size()), MPI_UNSIGNED_LONG_LONG, 0, result._node_comm);
+    if (shape[0] == -1ull) {
+      throw hdf5_read_error("Node leader can not read dataset " + dataset.path());
+    }
+    result._shape.assign(shape.begin() + 1, shape.begin() + 1 + shape[0]);
+    MPI_Aint bytes = leader ? MPI_Aint(result.size() * sizeof(T)) : 0;
+    T*       base  = nullptr;
+    if (MPI_Win_allocate_shared(bytes, sizeof(T), MPI_INFO_NULL, result._node_comm, &base, &result._win) != MPI_SUCCESS) {
+      throw hdf5_read_error("Can not allocate shared memory for dataset " + dataset.path());
+    }
+    MPI_Aint size;
+    int      disp_unit;
+    MPI_Win_shared_query(result._win, 0, &size, &disp_unit, &base);
+    result._data = base;
+    // leader reads the data, status is broadcast after the fence so that all ranks leave together
+    int  status = 0;
+    auto error  = std::exception_ptr();
+    MPI_Win_fence(MPI_MODE_NOPRECEDE, result._win);
+    if (leader && result.size() != 0) {
+      try {
+        read_dataset(dataset.current_id(), dataset.path(), base);
+      } catch (...) {
+        status = 1;
+        error  = std::current_exception();
+      }
+    }
+    MPI_Win_fence(MPI_MODE_NOSUCCEED, result._win);
+    MPI_Bcast(&status, 1, MPI_INT, 0, result._node_comm);
+    if (error) std::rethrow_exception(error);
+    if (status != 0) {
+      throw hdf5_read_error("Node leader can not read dataset " + dataset.path());
+    }
+    return result;
+  }
+
+}  // namespace green::h5pp
+
+#endif  // H5PP_SHARED_H
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#ifndef H5PP_SPARSE_H
+#define H5PP_SPARSE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "common.h"
+
+namespace green::h5pp {
+
+  /**
+   * Sparse matrix in compressed sparse row format. Column indices and values of row `i' are stored in the range
+   * [indptr[i], indptr[i + 1]) of `indices' and `values'.
+   *
+   * Stored as a group with `indptr', `indices', `values' and `shape' datasets and `h5pp_format' attribute set to "csr",
+   * which follows the layout used by scipy.sparse.
+   *
+   * @tparam T - type of values
+   * @tparam Index - type of indices
+   */
+  template <typename T, typename Index = int64_t>
+  struct csr_matrix {
+    using value_type = T;
+    using index_type = Index;
+    // number of rows and columns
+    std::array<size_t, 2> shape{{0, 0}};
+    // row pointers, `shape[0] + 1' elements
+    std::vector<Index>    indptr{0};
+    // column indices of non-zero elements
+    std::vector<Index>    indices;
+    // values of non-zero elements
+    std::vector<T>        values;
+
+    size_t                nnz() const { return values.size(); }
+  };
+
+  /**
+   * Sparse matrix in coordinate format, elements can be in arbitrary order.
+   *
+   * Stored as a group with `row', `col', `values' and `shape' datasets and `h5pp_format' attribute set to "coo". Elements
+   * are sorted by rows on write and `indptr' dataset with row pointers is added, so that rows can be read selectively.
+   *
+   * @tparam T - type of values
+   * @tparam Index - type of indices
+   */
+  template <typename T, typename Index = int64_t>
+  struct coo_matrix {
+    using value_type = T;
+    using index_type = Index;
+    // number of rows and columns
+    std::array<size_t, 2> shape{{0, 0}};
+    // row indices of non-zero elements
+    std::vector<Index>    row;
+    // column indices of non-zero elements
+    std::vector<Index>    col;
+    // values of non-zero elements
+    std::vector<T>        values;
+
+    size_t                nnz() const { return values.size(); }
+  };
+
+  template <typename T>
+  struct is_csr_t : std::false_type {};
+  template <typename T, typename Index>
+  struct is_csr_t<csr_matrix<T, Index>> : std::true_type {};
+  template <typename T>
+  struct is_coo_t : std::false_type {};
+  template <typename T, typename Index>
+  struct is_coo_t<coo_matrix<T, Index>> : std::true_type {};
+  template <typename T>
+  constexpr bool is_csr_matrix = is_csr_t<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+  template <typename T>
+  constexpr bool is_coo_matrix = is_coo_t<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+  template <typename T>
+  constexpr bool is_sparse = is_csr_matrix<T> || is_coo_matrix<T>;
+
+  namespace internal {
+    template <typename T>
+    void write_sparse_member(hid_t group_id, const std::string& name, const T& rhs) {
+      hid_t d_id = create_dataset(group_id, name, rhs);
+      H5Dclose(d_id);
+    }
+
+    template <typename T>
+    void read_sparse_member(hid_t group_id, const std::string& path, const std::string& name, T& rhs) {
+      hid_t d_id = H5Dopen2(group_id, name.c_str(), H5P_DEFAULT);
+      if (d_id == H5I_INVALID_HID) {
+        throw hdf5_read_error("Sparse matrix " + path + " does not have " + name + " dataset");
+      }
+      try {
+        read_dataset(d_id, path + "/" + name, rhs);
+      } catch (...) {
+        H5Dclose(d_id);
+        throw;
+      }
+      H5Dclose(d_id);
+    }
+
+    template <typename T>
+    void read_sparse_member_range(hid_t group_id, const std::string& path, const std::string& name, size_t offset, size_t count,
+                                  std::vector<T>& rhs) {
+      rhs.resize(count);
+      if (count == 0) return;
+      hid_t d_id = H5Dopen2(group_id, name.c_str(), H5P_DEFAULT);
+      if (d_id == H5I_INVALID_HID) {
+        throw hdf5_read_error("Sparse matrix " + path + " does not have " + name + " dataset");
+      }
+      try {
+        read_hyperslab(d_id, path + "/" + name, {offset}, {count}, rhs.data());
+      } catch (...) {
+        H5Dclose(d_id);
+        throw;
+      }
+      H5Dclose(d_id);
+    }
+
+    template <typename T>
+    constexpr const char* sparse_format_name() {
+      return is_csr_matrix<T> ? "csr" : "coo";
+    }
+  }  // namespace internal
+
+  /**
+   * @param group_id - id of the group
+   * @return format of the sparse matrix stored in the group, empty string if group does not contain sparse matrix
+   */
+  inline std::string sparse_format(hid_t group_id) {
+    std::string format;
+    if (attribute_exists(group_id, "h5pp_format")) read_attribute(group_id, "h5pp_format", format);
+    return format;
+  }
+
+  /**
+   * Create group `name' and store sparse matrix `rhs' in it. All parent groups will be created if needed.
+   *
+   * @tparam T - type of sparse matrix
+   * @param root_parent - id of the parent group
+   * @param name - path of the group
+   * @param rhs - sparse matrix to be written
+   * @return id of the created group
+   */
+  template <typename T>
+  std::enable_if_t<is_sparse<T>, hid_t> write_sparse(hid_t root_parent, const std::string& name, const T& rhs) {
+    using index_type = typename T::index_type;
+    if constexpr (is_csr_matrix<T>) {
+      if (rhs.indptr.size() != rhs.shape[0] + 1 || rhs.indices.size() != rhs.values.size() ||
+          size_t(rhs.indptr.back()) != rhs.values.size()) {
+        throw hdf5_write_error("Inconsistent CSR matrix " + name);
+      }
+    } else {
+      if (rhs.row.size() != rhs.values.size() || rhs.col.size() != rhs.values.size() ||
+          std::any_of(rhs.row.begin(), rhs.row.end(), [&rhs](index_type r) { return r < 0 || size_t(r) >= rhs.shape[0]; })) {
+        throw hdf5_write_error("Inconsistent COO matrix " + name);
+      }
+    }
+    hid_t group_id = create_group(root_parent, name);
+    write_attribute(group_id, "h5pp_format", std::string(internal::sparse_format_name<T>()));
+    internal::write_sparse_member(group_id, "shape", rhs.shape);
+    if constexpr (is_csr_matrix<T>) {
+      internal::write_sparse_member(group_id, "indptr", rhs.indptr);
+      internal::write_sparse_member(group_id, "indices", rhs.indices);
+      internal::write_sparse_member(group_id, "values", rhs.values);
+    } else {
+      // sort elements by rows and build row pointers for row-selective reads
+      std::vector<size_t> order(rhs.nnz());
+      std::iota(order.begin(), order.end(), 0ul);
+      std::stable_sort(order.begin(), order.end(), [&rhs](size_t a, size_t b) {
+        return std::make_pair(rhs.row[a], rhs.col[a]) < std::make_pair(rhs.row[b], rhs.col[b]);
+      });
+      std::vector<index_type> indptr(rhs.shape[0] + 1, 0);
+      std::vector<index_type> indices(rhs.nnz());
+      for (size_t i = 0; i < rhs.nnz(); ++i) ++indptr[rhs.row[i] + 1];
+      std::partial_sum(indptr.begin(), indptr.end(), indptr.begin());
+      std::transform(order.begin(), order.end(), indices.begin(), [&rhs](size_t i) { return rhs.row[i]; });
+      internal::write_sparse_member(group_id, "row", indices);
+      std::transform(order.begin(), order.end(), indices.begin(), [&rhs](size_t i) { return rhs.col[i]; });
+      internal::write_sparse_member(group_id, "col", indices);
+      std::vector<typename T::value_type> values(rhs.nnz());
+      std::transform(order.begin(), order.end(), values.begin(), [&rhs](size_t i) { return rhs.values[i]; });
+      internal::write_sparse_member(group_id, "values", values);
+      internal::write_sparse_member(group_id, "indptr", indptr);
+    }
+    return group_id;
+  }
+
+  /**
+   * Read sparse matrix from group `group_id'. `hdf5_read_error' is thrown if the group does not contain sparse matrix of
+   * the requested format.
+   *
+   * @tparam T - type of sparse matrix
+   * @param group_id - id of the group
+   * @param path - absolute path to the group (needed for error message)
+   * @param rhs - target sparse matrix
+   */
+  template <typename T>
+  std::enable_if_t<is_sparse<T>> read_sparse(hid_t group_id, const std::string& path, T& rhs) {
+    if (sparse_format(group_id) != internal::sparse_format_name<T>()) {
+      throw hdf5_read_error(path + " does not contain " + internal::sparse_format_name<T>() + " sparse matrix");
+    }
+    internal::read_sparse_member(group_id, path, "shape", rhs.shape);
+    if constexpr (is_csr_matrix<T>) {
+      internal::read_sparse_member(group_id, path, "indptr", rhs.indptr);
+      internal::read_sparse_member(group_id, path, "indices", rhs.indices);
+    } else {
+      internal::read_sparse_member(group_id, path, "row", rhs.row);
+      internal::read_sparse_member(group_id, path, "col", rhs.col);
+    }
+    internal::read_sparse_member(group_id, path, "values", rhs.values);
+  }
+
+  /**
+   * Read `count' rows of sparse matrix starting from row `first'. Only non-zero elements of the requested rows are read.
+   * Resulting matrix has `count' rows, row indices are relative to `first'.
+   *
+   * @tparam T - type of sparse matrix
+   * @param group_id - id of the group
+   * @param path - absolute path to the group (needed for error message)
+   * @param first - first row to be read
+   * @param count - number of rows to be read
+   * @param rhs - target sparse matrix
+   */
+  template <typename T>
+  std::enable_if_t<is_sparse<T>> read_sparse_rows(hid_t group_id, const std::string& path, size_t first, size_t count, T& rhs) {
+    using index_type = typename T::index_type;
+    if (sparse_format(group_id) != internal::sparse_format_name<T>()) {
+      throw hdf5_read_error(path + " does not contain " + internal::sparse_format_name<T>() + " sparse matrix");
+    }
+    std::array<size_t, 2> shape;
+    internal::read_sparse_member(group_id, path, "shape", shape);
+    if (first + count > shape[0]) {
+      throw hdf5_read_error("Rows range is out of bounds of sparse matrix " + path);
+    }
+    std::vector<index_type> indptr;
+    internal::read_sparse_member_range(group_id, path, "indptr", first, count + 1, indptr);
+    size_t begin = indptr.front();
+    size_t nnz   = indptr.back() - indptr.front();
+    rhs.shape    = {{count, shape[1]}};
+    if constexpr (is_csr_matrix<T>) {
+      for (auto& ptr : indptr) ptr -= index_type(begin);
+      rhs.indptr = std::move(indptr);
+      internal::read_sparse_member_range(group_id, path, "indices", begin, nnz, rhs.indices);
+    } else {
+      internal::read_sparse_member_range(group_id, path, "row", begin, nnz, rhs.row);
+      internal::read_sparse_member_range(group_id, path, "col", begin, nnz, rhs.col);
+      for (auto& row : rhs.row) row -= index_type(first);
+    }
+    internal::read_sparse_member_range(group_id, path, "values", begin, nnz, rhs.values);
+  }
+
+}  // namespace green::h5pp
+
+#endif  // H5PP_SPARSE_H
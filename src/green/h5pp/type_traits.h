@@ -6,7 +6,10 @@
 #ifndef H5PP_TYPE_TRAITS_H
 #define H5PP_TYPE_TRAITS_H
 
+#include <array>
 #include <complex>
+#include <cstddef>
+#include <tuple>
 #include <type_traits>
 #include <vector>
 
@@ -17,8 +20,29 @@ namespace green::h5pp {
   struct is_complex_t<std::complex<T>> : std::true_type {};
   template <typename T>
   constexpr bool is_complex_scalar = is_complex_t<std::remove_reference_t<T>>::value;
+  // real_type_t is the type of real and imaginary parts for complex types and the type itself otherwise
   template <typename T>
-  constexpr bool is_scalar = std::is_arithmetic_v<T> || std::is_arithmetic_v<std::remove_reference_t<T>> || is_complex_scalar<T>;
+  struct real_type {
+    using type = T;
+  };
+  template <typename T>
+  struct real_type<std::complex<T>> {
+    using type = T;
+  };
+  template <typename T>
+  using real_type_t = typename real_type<std::remove_cv_t<std::remove_reference_t<T>>>::type;
+  /**
+   * Compound type traits. Specialization for a user struct should derive from std::true_type and provide static `fields()'
+   * method that returns std::tuple of `compound_field' descriptors, see `H5PP_REGISTER_COMPOUND'.
+   */
+  template <typename T>
+  struct compound_traits : std::false_type {};
+  template <typename T>
+  constexpr bool is_compound_scalar = compound_traits<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+
+  template <typename T>
+  constexpr bool is_scalar = std::is_arithmetic_v<T> || std::is_arithmetic_v<std::remove_reference_t<T>> || is_complex_scalar<T> ||
+                             is_compound_scalar<T>;
   template <typename T>
   constexpr bool is_string = std::is_same_v<std::remove_reference_t<std::remove_const_t<T>>, std::string>;
 
@@ -73,6 +97,54 @@ namespace green::h5pp {
   template <typename T>
   constexpr bool is_resizable_nd = has_resizend_t<T>::value;
 
+  /**
+   * Description of a single member of a compound type
+   *
+   * @tparam C - type of the struct
+   * @tparam M - type of the member
+   */
+  template <typename C, typename M>
+  struct compound_field {
+    // name of the field in HDF5 compound type
+    const char* name;
+    // pointer to the member
+    M C::*      member;
+    // offset of the member within the struct
+    size_t      offset;
+  };
+
+  /**
+   * Create descriptor of a compound type member
+   */
+  template <typename C, typename M>
+  constexpr compound_field<C, M> field(const char* name, M C::*member, size_t offset) {
+    return compound_field<C, M>{name, member, offset};
+  }
+
+  template <typename T>
+  struct is_std_array_t : std::false_type {};
+  template <typename T, size_t N>
+  struct is_std_array_t<std::array<T, N>> : std::true_type {};
+
 }  // namespace green::h5pp
 
+/**
+ * Describe field `member' of struct `Type' with the same name in HDF5 compound type
+ */
+#define H5PP_FIELD(Type, member) green::h5pp::field(#member, &Type::member, offsetof(Type, member))
+
+/**
+ * Register trivially copyable struct `Type' as HDF5 compound type, so that `Type', arrays and vectors of `Type' can be
+ * written and read as any other scalar type. Should be used in the global namespace, e.g.
+ *
+ *   H5PP_REGISTER_COMPOUND(orbital, H5PP_FIELD(orbital, energy), H5PP_FIELD(orbital, spin))
+ *
+ * Fields can be arithmetic types, std::complex, other registered structs or std::array of them.
+ */
+#define H5PP_REGISTER_COMPOUND(Type, ...)                                    \
+  template <>                                                                \
+  struct green::h5pp::compound_traits<Type> : std::true_type {               \
+    static auto fields() { return std::make_tuple(__VA_ARGS__); }            \
+  };
+
 #endif  // H5PP_TYPE_TRAITS_H
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace green::h5pp::utils {
@@ -45,6 +46,56 @@ namespace green::h5pp::utils {
     return res;
   } // LCOV_EXCL_LINE
 
+  /**
+   * Call `f' for every non-empty token of `s' separated by `delimiter'. Tokens are views into `s', nothing is allocated.
+   *
+   * @param s - string to be tokenized
+   * @param delimiter - token delimiter
+   * @param f - callable that accepts std::string_view
+   */
+  template <typename F>
+  void for_each_token(std::string_view s, char delimiter, F&& f) {
+    size_t pos = 0;
+    while (pos < s.size()) {
+      size_t new_pos = s.find(delimiter, pos);
+      if (new_pos == std::string_view::npos) new_pos = s.size();
+      if (new_pos > pos) f(s.substr(pos, new_pos - pos));
+      pos = new_pos + 1;
+    }
+  }
+
+  /**
+   * @return `root' and `name' joined with `/' using a single allocation
+   */
+  inline std::string join_path(std::string_view root, std::string_view name) {
+    std::string res;
+    res.reserve(root.size() + name.size() + 1);
+    res.append(root).append(1, '/').append(name);
+    return res;
+  }
+
+  /**
+   * Reusable buffer for building absolute HDF5 paths component by component. Memory of the buffer is kept between uses,
+   * so after the first few paths no allocations happen.
+   */
+  class path_builder {
+  public:
+    path_builder& clear() {
+      _buffer.clear();
+      return *this;
+    }
+    path_builder& append(std::string_view component) {
+      _buffer.append(1, '/').append(component);
+      return *this;
+    }
+    const char*        c_str() const { return _buffer.c_str(); }
+    const std::string& str() const { return _buffer; }
+    bool               empty() const { return _buffer.empty(); }
+
+  private:
+    std::string _buffer;
+  };
+
 }  // namespace green::h5pp::utils
 
 #endif  // H5PP_UTILS_H
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#include "green/h5pp/sharded_archive.h"
+
+#include <filesystem>
+
+namespace {
+  // format attribute of the manifest root group and the dataset with the names of the shards
+  const std::string manifest_format = "sharded";
+  const std::string manifest_shards = ".h5pp_shards";
+  // attribute of the manifest root group with the version of the scheme that places objects into shards
+  const std::string manifest_placement = "h5pp_placement";
+  const int         placement_version  = 1;
+
+  /**
+   * 64-bit FNV-1a hash of `name'. Bytes are processed one at a time, so the result does not depend on the byte order of the
+   * platform. Placement of existing archives depends on it and it should not be changed without a new placement version.
+   */
+  uint64_t placement_hash(const std::string& name) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : name) {
+      hash ^= c;
+      hash *= 0x100000001b3ull;
+    }
+    return hash;
+  }
+
+  /**
+   * Collect names of all links in a group
+   */
+  herr_t collect_link(hid_t, const char* name, const H5L_info_t*, void* op_data) {
+    static_cast<std::vector<std::string>*>(op_data)->emplace_back(name);
+    return 0;
+  }
+
+  /**
+   * @return top-level component of `path'
+   */
+  std::string top_level_name(const std::string& path) {
+    size_t begin = path.find_first_not_of('/');
+    if (begin == std::string::npos) {
+      throw green::h5pp::hdf5_notsupported_error("Root of sharded archive can not be subscripted");
+    }
+    size_t end = path.find('/', begin);
+    return path.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+  }
+}  // namespace
+
+green::h5pp::sharded_archive::sharded_archive(const std::string& filename, const std::string& access_type, size_t shards,
+                                              const access_options& options) {
+  open(filename, access_type, shards, options);
+}
+
+green::h5pp::sharded_archive::~sharded_archive() { close(); }
+
+void green::h5pp::sharded_archive::open(const std::string& filename, const std::string& access_type, size_t shards,
+                                        const access_options& options) {
+  if (!_filename.empty()) {
+    throw hdf5_file_access_error("Sharded archive is already opened. Please close current archive before opening another.");
+  }
+  if (access_type != "r" && access_type != "w" && access_type != "a") {
+    throw hdf5_unknown_access_type_error("Unknown access type '" + access_type + "'. Should be 'r', 'w' or 'a'");
+  }
+  bool create = access_type == "w" || (access_type == "a" && !std::filesystem::exists(filename));
+  std::vector<std::string>              names;
+  std::vector<std::unique_ptr<archive>> opened;
+  if (create) {
+    if (shards == 0) {
+      throw hdf5_file_access_error("Number of shards should be positive to create sharded archive '" + filename + "'");
+    }
+    std::filesystem::path path(filename);
+    for (size_t i = 0; i < shards; ++i) {
+      names.push_back(path.stem().string() + ".shard" + std::to_string(i) + path.extension().string());
+    }
+    archive manifest(filename, "w");
+    write_attribute(manifest.current_id(), "h5pp_format", manifest_format);
+    write_attribute(manifest.current_id(), manifest_placement, placement_version);
+    manifest[manifest_shards] << names;
+    manifest.close();
+    auto dir = path.parent_path();
+    for (const auto& name : names) opened.push_back(std::make_unique<archive>((dir / name).string(), "w", options));
+  } else {
+    archive     manifest(filename, "r");
+    std::string format;
+    if (attribute_exists(manifest.current_id(), "h5pp_format")) read_attribute(manifest.current_id(), "h5pp_format", format);
+    if (format != manifest_format || !manifest.is_data(manifest_shards)) {
+      throw hdf5_file_access_error("'" + filename + "' is not a sharded archive manifest");
+    }
+    int placement = 0;
+    if (attribute_exists(manifest.current_id(), manifest_placement)) {
+      read_attribute(manifest.current_id(), manifest_placement, placement);
+    }
+    if (placement != placement_version) {
+      throw hdf5_file_access_error("Sharded archive '" + filename + "' uses unsupported placement of objects into shards");
+    }
+    manifest[manifest_shards] >> names;
+    manifest.close();
+    opened.resize(names.size());
+  }
+  _filename    = filename;
+  _access_type = access_type == "r" ? "r" : "a";
+  _options     = options;
+  _shard_names = std::move(names);
+  _shards      = std::move(opened);
+}
+
+void green::h5pp::sharded_archive::close() {
+  for (auto& shard : _shards) {
+    if (shard) shard->close();
+  }
+  _shards.clear();
+  _shard_names.clear();
+  _filename.clear();
+}
+
+void green::h5pp::sharded_archive::flush() {
+  for (auto& shard : _shards) {
+    if (shard) shard->flush();
+  }
+}
+
+green::h5pp::object green::h5pp::sharded_archive::operator[](const std::string& path) {
+  return shard(shard_index(path))[path];
+}
+
+size_t green::h5pp::sharded_archive::shard_index(const std::string& path) const {
+  if (_shard_names.empty()) {
+    throw hdf5_file_access_error("Sharded archive is not opened");
+  }
+  std::string name = top_level_name(path);
+  return placement_hash(name) % _shard_names.size();
+}
+
+green::h5pp::archive& green::h5pp::sharded_archive::shard(size_t i) {
+  if (i >= _shards.size()) {
+    throw hdf5_file_access_error("Shard " + std::to_string(i) + " does not exist in sharded archive '" + _filename + "'");
+  }
+  if (!_shards[i]) _shards[i] = std::make_unique<archive>(shard_path(i), _access_type, _options);
+  return *_shards[i];
+}
+
+void green::h5pp::sharded_archive::link_shards() {
+  if (_access_type == "r") {
+    throw hdf5_write_error("Can not link shards of readonly sharded archive '" + _filename + "'");
+  }
+  archive manifest(_filename, "a");
+  for (size_t i = 0; i < _shards.size(); ++i) {
+    std::vector<std::string> names;
+    if (H5Literate(shard(i).current_id(), H5_INDEX_NAME, H5_ITER_NATIVE, NULL, collect_link, &names) < 0) {
+      throw hdf5_read_error("Can not list objects of shard '" + shard_path(i) + "'");
+    }
+    for (const auto& name : names) {
+      // internal objects of the shards, e.g. deduplication index, are not exposed
+      if (name.rfind(".h5pp", 0) == 0 || H5Lexists(manifest.current_id(), name.c_str(), H5P_DEFAULT) > 0) continue;
+      if (H5Lcreate_external(_shard_names[i].c_str(), ("/" + name).c_str(), manifest.current_id(), name.c_str(), H5P_DEFAULT,
+                             H5P_DEFAULT) < 0) {
+        throw hdf5_write_error("Can not link '" + name + "' of shard '" + shard_path(i) + "' into manifest");
+      }
+    }
+  }
+  manifest.close();
+}
+
+std::string green::h5pp::sharded_archive::shard_path(size_t i) const {
+  return (std::filesystem::path(_filename).parent_path() / _shard_names[i]).string();
+}
@@ -7,6 +7,7 @@
 #include <filesystem>
 
 #include "green/h5pp/archive.h"
+#include "green/h5pp/sharded_archive.h"
 #include "test_common.h"
 
 TEST_CASE("Archive") {
@@ -148,6 +149,521 @@ TEST_CASE("Archive") {
     REQUIRE_THROWS_AS(group.move("TEST2", "TEST3"), green::h5pp::hdf5_write_error);
     std::filesystem::remove(std::filesystem::path(filename));
   }
+  SECTION("SWMR") {
+    std::string                  filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::access_options  options;
+    options.swmr = true;
+    green::h5pp::archive         ar(filename, "w", options);
+    std::vector<double>          record(4, 1.0);
+    auto                         data = ar["GROUP/DATA"];
+    data.append(record);
+    ar.start_swmr_write();
+    ar.flush();
+    green::h5pp::archive reader(filename, "r", options);
+    std::vector<double>  result;
+    auto                 reader_data = reader["GROUP/DATA"];
+    reader_data >> result;
+    REQUIRE(result.size() == 4);
+    record.assign(4, 2.0);
+    data.append(record);
+    ar.flush();
+    reader_data >> result;
+    REQUIRE(result.size() == 8);
+    REQUIRE(std::abs(result[7] - 2.0) < 1e-12);
+    ar.close();
+    REQUIRE_THROWS_AS(reader.start_swmr_write(), green::h5pp::hdf5_write_error);
+    reader.close();
+    green::h5pp::archive no_swmr(filename, "a");
+    REQUIRE_THROWS_AS(no_swmr.start_swmr_write(), green::h5pp::hdf5_file_access_error);
+    no_swmr.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+  SECTION("Family Driver") {
+    std::string                 root = TEST_PATH;
+    std::string                 base = root + "/" + random_name();
+    green::h5pp::access_options options;
+    options.driver             = green::h5pp::FAMILY_DRIVER;
+    options.family_member_size = 1ul << 20;
+    std::vector<double> data(300000, 1.0);
+    green::h5pp::archive ar;
+    REQUIRE_THROWS_AS(ar.open(base + "-%d", "r", options), green::h5pp::hdf5_file_access_error);
+    ar.open(base + "-%d", "w", options);
+    ar["DATA"] << data;
+    ar.close();
+    for (int i = 0; i < 3; ++i) REQUIRE(std::filesystem::exists(base + "-" + std::to_string(i)));
+    std::vector<double> result;
+    ar.open(base + "-%d", "r", options);
+    ar["DATA"] >> result;
+    REQUIRE(result == data);
+    ar.close();
+    ar.open(base + "-%d", "a", options);
+    ar["DATA2"] << 1.0;
+    ar.close();
+    for (int i = 0; i < 3; ++i) std::filesystem::remove(base + "-" + std::to_string(i));
+    // file name is used as a printf format by HDF5 and should contain exactly one integer pattern
+    for (const char* pattern : {"-%s", "-%d-%d", "-plain", "-%d%", "-%n", "-%ld"}) {
+      REQUIRE_THROWS_AS(ar.open(base + pattern, "w", options), green::h5pp::hdf5_file_access_error);
+    }
+    ar.open(base + "-100%%-%03d", "w", options);
+    ar["DATA"] << 1.0;
+    ar.close();
+    REQUIRE(std::filesystem::exists(base + "-100%-000"));
+    ar.open(base + "-100%%-%03d", "r", options);
+    ar.close();
+    std::filesystem::remove(base + "-100%-000");
+  }
+  SECTION("Split Driver") {
+    std::string                 root = TEST_PATH;
+    std::string                 base = root + "/" + random_name();
+    green::h5pp::access_options options;
+    options.driver         = green::h5pp::SPLIT_DRIVER;
+    options.split_meta_ext = "%s.meta";
+    std::vector<double>  data(100, 2.0);
+    green::h5pp::archive ar(base, "a", options);
+    ar["GROUP/DATA"] << data;
+    ar.close();
+    REQUIRE(std::filesystem::exists(base + ".meta"));
+    REQUIRE(std::filesystem::exists(base + "-r.h5"));
+    REQUIRE(std::filesystem::file_size(base + "-r.h5") >= data.size() * sizeof(double));
+    std::vector<double> result;
+    ar.open(base, "r", options);
+    ar["GROUP/DATA"] >> result;
+    REQUIRE(result == data);
+    ar.close();
+    std::filesystem::remove(base + ".meta");
+    std::filesystem::remove(base + "-r.h5");
+  }
+  SECTION("Copy") {
+    std::string          root = TEST_PATH;
+    std::string          filename = root + "/"s + random_name();
+    green::h5pp::archive src(root + "/test.h5");
+    green::h5pp::archive dst(filename, "w");
+    src["GROUP"].copy_to(dst, "CHECKPOINT/GROUP");
+    src["GROUP/VECTOR_DATASET"].copy_to(dst["COPIES"], "VECTOR");
+    green::h5pp::copy_options options;
+    options.shallow = true;
+    src["GROUP"].copy_to(dst, "SHALLOW", options);
+    REQUIRE(dst.is_data("CHECKPOINT/GROUP/INNER_GROUP/DATASET"));
+    REQUIRE(dst.is_data("SHALLOW/SCALAR_DATASET"));
+    REQUIRE(dst.has_group("SHALLOW/INNER_GROUP"));
+    REQUIRE_FALSE(dst.is_data("SHALLOW/INNER_GROUP/DATASET"));
+    std::vector<double> original, copy;
+    src["GROUP/VECTOR_DATASET"] >> original;
+    dst["COPIES/VECTOR"] >> copy;
+    REQUIRE(original == copy);
+    REQUIRE_THROWS_AS(src["GROUP"].copy_to(dst, "COPIES/VECTOR"), green::h5pp::hdf5_copy_object_error);
+    auto vector = dst["COPIES/VECTOR"];
+    REQUIRE_THROWS_AS(src["GROUP"].copy_to(vector, "GROUP"), green::h5pp::hdf5_copy_object_error);
+    green::h5pp::object invalid;
+    REQUIRE_THROWS_AS(invalid.copy_to(dst, "INVALID"), green::h5pp::hdf5_copy_object_error);
+    REQUIRE_THROWS_AS(dst["COPIES"].copy_to(src, "COPIES"), green::h5pp::hdf5_write_error);
+    dst.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+  SECTION("Persistent Free Space") {
+    std::string                   filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::creation_options creation;
+    creation.fspace_strategy    = H5F_FSPACE_STRATEGY_FSM_AGGR;
+    creation.persist_free_space = true;
+    green::h5pp::archive ar(filename, "w", {}, creation);
+    auto                 run_iterations = [&](size_t n) {
+      for (size_t i = 0; i < n; ++i) {
+        // space of the unlinked dataset is released in one session and allocated again in another one
+        if (ar.is_data("DATA")) H5Ldelete(ar.file_id(), "DATA", H5P_DEFAULT);
+        ar.close();
+        ar.open(filename, "a");
+        ar["DATA"] << std::vector<double>(20000, double(i));
+        ar["MARKER_" + std::to_string(i)] << i;
+        ar.close();
+        ar.open(filename, "a");
+      }
+      return std::filesystem::file_size(filename);
+    };
+    auto size_5  = run_iterations(5);
+    auto size_50 = run_iterations(50);
+    REQUIRE(size_50 < 2 * size_5);
+    green::h5pp::creation_options wrong;
+    wrong.page_size = 1;
+    ar.close();
+    REQUIRE_THROWS_AS(ar.open(filename, "w", {}, wrong), green::h5pp::hdf5_file_access_error);
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+  SECTION("Page Buffer") {
+    std::string                   filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::creation_options creation;
+    creation.fspace_strategy = H5F_FSPACE_STRATEGY_PAGE;
+    creation.page_size       = 4096;
+    green::h5pp::access_options options;
+    options.page_buffer_size = 1 << 20;
+    green::h5pp::archive ar(filename, "w", options, creation);
+    for (int i = 0; i < 100; ++i) {
+      ar["GROUP/DATA_" + std::to_string(i)] << std::vector<double>(8, double(i));
+    }
+    ar.close();
+    ar.open(filename, "r", options);
+    std::vector<double> data;
+    ar["GROUP/DATA_42"] >> data;
+    REQUIRE(data == std::vector<double>(8, 42.0));
+    ar.close();
+    options.page_buffer_size = 1024;
+    REQUIRE_THROWS_AS(ar.open(filename, "r", options), green::h5pp::hdf5_file_access_error);
+    std::string not_paged = TEST_PATH + "/"s + random_name();
+    ar.open(not_paged, "w");
+    ar.close();
+    options.page_buffer_size = 1 << 20;
+    REQUIRE_THROWS_AS(ar.open(not_paged, "r", options), green::h5pp::hdf5_file_access_error);
+    std::filesystem::remove(std::filesystem::path(filename));
+    std::filesystem::remove(std::filesystem::path(not_paged));
+  }
+  SECTION("Compact") {
+    std::string          filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::archive ar(filename, "w");
+    ar.set_attribute("version", "1.0"s);
+    ar.set_attribute("iteration", 10);
+    ar["GROUP/LARGE"] << std::vector<double>(1000000, 2.0);
+    ar["GROUP/SMALL"] << std::vector<double>(100, 1.0);
+    ar["GROUP"].set_attribute("units", "eV"s);
+    H5Lcreate_hard(ar.file_id(), "GROUP/SMALL", ar.file_id(), "SHARED", H5P_DEFAULT, H5P_DEFAULT);
+    H5Lcreate_soft("/GROUP/SMALL", ar.file_id(), "SOFT", H5P_DEFAULT, H5P_DEFAULT);
+    H5Ldelete(ar.file_id(), "GROUP/LARGE", H5P_DEFAULT);
+    ar.close();
+    ar.open(filename, "a");
+    auto size_before = std::filesystem::file_size(filename);
+    ar.compact();
+    auto size_after = std::filesystem::file_size(filename);
+    REQUIRE(size_after < size_before / 10);
+    REQUIRE_FALSE(std::filesystem::exists(filename + ".compact"));
+    REQUIRE(ar.get_attribute<std::string>("version") == "1.0");
+    REQUIRE(ar.get_attribute<int>("iteration") == 10);
+    REQUIRE(ar["GROUP"].get_attribute<std::string>("units") == "eV");
+    REQUIRE_FALSE(ar.is_data("GROUP/LARGE"));
+    std::vector<double> data;
+    ar["SOFT"] >> data;
+    REQUIRE(data == std::vector<double>(100, 1.0));
+    H5O_info_t info;
+    H5Oget_info_by_name(ar.file_id(), "SHARED", &info, H5P_DEFAULT);
+    REQUIRE(info.rc == 2);
+    H5L_info_t link_info;
+    H5Lget_info(ar.file_id(), "SOFT", &link_info, H5P_DEFAULT);
+    REQUIRE(link_info.type == H5L_TYPE_SOFT);
+    ar["NEW"] << 1.0;
+    ar.close();
+    ar.open(filename, "r");
+    REQUIRE_THROWS_AS(ar.compact(), green::h5pp::hdf5_write_error);
+    ar.close();
+    // file space options of the file are kept even if archive is opened without them
+    ar.open(filename, "w", {}, {H5F_FSPACE_STRATEGY_PAGE, true, 1, 8192});
+    ar["DATA"] << std::vector<double>(100, 1.0);
+    ar.close();
+    ar.open(filename, "a");
+    ar.compact();
+    hid_t                 fcpl = H5Fget_create_plist(ar.file_id());
+    H5F_fspace_strategy_t strategy;
+    hbool_t               persist;
+    hsize_t               threshold, page_size;
+    H5Pget_file_space_strategy(fcpl, &strategy, &persist, &threshold);
+    H5Pget_file_space_page_size(fcpl, &page_size);
+    H5Pclose(fcpl);
+    REQUIRE(strategy == H5F_FSPACE_STRATEGY_PAGE);
+    REQUIRE(persist);
+    REQUIRE(page_size == 8192);
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+  SECTION("Checkpoint") {
+    std::string          filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::archive ar(filename, "w");
+    ar["STATIC"] << std::vector<double>(1000, 1.0);
+    ar["ITERATION"] << 0;
+    ar.close();
+    ar.open(filename, "a");
+    // object that is still open would be copied with unflushed metadata
+    {
+      auto iteration = ar["ITERATION"];
+      iteration << -1;
+      REQUIRE_THROWS_AS(ar.begin_checkpoint(), green::h5pp::hdf5_write_error);
+      REQUIRE_FALSE(ar.in_checkpoint());
+      REQUIRE_FALSE(std::filesystem::exists(filename + ".checkpoint"));
+      iteration << 0;
+    }
+    ar.begin_checkpoint();
+    REQUIRE(ar.in_checkpoint());
+    REQUIRE(ar.get_change_tracking());
+    REQUIRE_THROWS_AS(ar.begin_checkpoint(), green::h5pp::hdf5_write_error);
+    REQUIRE_THROWS_AS(ar.compact(), green::h5pp::hdf5_write_error);
+    REQUIRE(ar.in_checkpoint());
+    ar["STATIC"] << std::vector<double>(1000, 1.0);
+    ar["ITERATION"] << 1;
+    REQUIRE(ar["STATIC"].has_attribute("h5pp_hash"));
+    // original file is not modified until commit
+    {
+      green::h5pp::archive original(filename, "r");
+      int                  iteration;
+      original["ITERATION"] >> iteration;
+      REQUIRE(iteration == 0);
+    }
+    ar.commit_checkpoint();
+    REQUIRE_FALSE(ar.in_checkpoint());
+    REQUIRE_FALSE(ar.get_change_tracking());
+    REQUIRE_FALSE(std::filesystem::exists(filename + ".checkpoint"));
+    int iteration;
+    ar["ITERATION"] >> iteration;
+    REQUIRE(iteration == 1);
+    // write of unchanged data is skipped, modify stored data behind the hash to observe it
+    ar.begin_checkpoint();
+    std::vector<double> modified(1000, 3.0);
+    H5Dwrite(ar["STATIC"].current_id(), H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, modified.data());
+    std::vector<double> data;
+    ar["STATIC"] << std::vector<double>(1000, 1.0);
+    ar["STATIC"] >> data;
+    REQUIRE(data == modified);
+    ar["STATIC"] << std::vector<double>(1000, 2.0);
+    ar["STATIC"] >> data;
+    REQUIRE(data == std::vector<double>(1000, 2.0));
+    // same bytes with different types are distinguished
+    REQUIRE(green::h5pp::internal::content_hash(std::vector<int32_t>(4, 1)) !=
+            green::h5pp::internal::content_hash(std::vector<uint32_t>(4, 1)));
+    // same bytes with different shape are not skipped
+    ar.set_overwrite_policy(green::h5pp::RESIZE_OVERWRITE);
+    ar["STATIC"] << std::vector<double>(500, 2.0);
+    ar["STATIC"] >> data;
+    REQUIRE(data.size() == 500);
+    ar.abort_checkpoint();
+    REQUIRE_FALSE(ar.in_checkpoint());
+    REQUIRE_FALSE(std::filesystem::exists(filename + ".checkpoint"));
+    ar["STATIC"] >> data;
+    REQUIRE(data == std::vector<double>(1000, 1.0));
+    // untracked write drops stored hash
+    ar["STATIC"] << std::vector<double>(1000, 1.0);
+    REQUIRE_FALSE(ar["STATIC"].has_attribute("h5pp_hash"));
+    // closing archive during checkpoint discards it
+    ar.begin_checkpoint();
+    ar["ITERATION"] << 2;
+    ar.close();
+    REQUIRE_FALSE(std::filesystem::exists(filename + ".checkpoint"));
+    ar.open(filename, "r");
+    ar["ITERATION"] >> iteration;
+    REQUIRE(iteration == 1);
+    REQUIRE_THROWS_AS(ar.begin_checkpoint(), green::h5pp::hdf5_write_error);
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+  SECTION("Interned Paths") {
+    std::string          filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::archive ar(filename, "w");
+    ar.set_path_interning(true);
+    auto group = ar["GROUP"];
+    REQUIRE(group.get_path_interning());
+    for (int i = 0; i < 10; ++i) {
+      group["DATA"] << i;
+    }
+    auto first  = group["DATA"];
+    auto second = group["DATA"];
+    REQUIRE(first.path() == "//GROUP/DATA");
+    // the same path is shared between objects
+    REQUIRE(&first.path() == &second.path());
+    int value;
+    second >> value;
+    REQUIRE(value == 9);
+    ar.set_path_interning(false);
+    auto third = ar["GROUP"]["DATA"];
+    REQUIRE(third.path() == first.path());
+    REQUIRE(&third.path() != &first.path());
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+  SECTION("Lazy Handles") {
+    std::string          filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::archive ar(filename, "w");
+    auto                 open_objects = [&ar]() { return H5Fget_obj_count(ar.file_id(), H5F_OBJ_GROUP | H5F_OBJ_DATASET); };
+    // chained subscript does not touch the file until data is written
+    auto                 data         = ar["A"]["B"]["C"];
+    REQUIRE(open_objects() == 0);
+    REQUIRE_FALSE(ar.has_group("A"));
+    data << std::vector<double>(10, 1.0);
+    REQUIRE(ar.has_group("A/B"));
+    REQUIRE(data.type() == green::h5pp::DATASET);
+    REQUIRE(open_objects() == 1);
+    // copies share the same HDF5 object
+    {
+      auto                            copy = data;
+      std::vector<green::h5pp::object> copies(10, data);
+      REQUIRE(open_objects() == 1);
+      copy << std::vector<double>(10, 2.0);
+    }
+    REQUIRE(open_objects() == 1);
+    std::vector<double> result;
+    data >> result;
+    REQUIRE(result == std::vector<double>(10, 2.0));
+    // subscript of a dataset is reported on first access
+    auto bad = ar["A"]["B"]["C"]["D"];
+    REQUIRE_THROWS_AS(bad.type(), green::h5pp::hdf5_notsupported_error);
+    // moved-from objects are invalid but can still be queried
+    auto moved = std::move(data);
+    REQUIRE(data.type() == green::h5pp::INVALID);
+    REQUIRE(data.current_id() == H5I_INVALID_HID);
+    data = std::move(moved);
+    REQUIRE(moved.type() == green::h5pp::INVALID);
+    REQUIRE(data.type() == green::h5pp::DATASET);
+    data = green::h5pp::object();
+    REQUIRE(open_objects() == 0);
+    ar.close();
+    ar.open(filename, "r");
+    REQUIRE_THROWS_AS(ar["A"]["X"], green::h5pp::hdf5_wrong_path_error);
+    auto group = ar["A"]["B"];
+    REQUIRE(open_objects() == 0);
+    REQUIRE(group.type() == green::h5pp::GROUP);
+    REQUIRE(open_objects() == 1);
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+  SECTION("Handle Cache") {
+    std::string                 filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::access_options options;
+    options.handle_cache_capacity = 2;
+    green::h5pp::archive ar(filename, "w", options);
+    auto                 open_objects = [&ar]() { return H5Fget_obj_count(ar.file_id(), H5F_OBJ_DATASET); };
+    ar["data/x"] << std::vector<double>(10, 1.0);
+    ar["data/y"] << std::vector<double>(5, 2.0);
+    ar["data/z"] << std::vector<double>(3, 3.0);
+    REQUIRE(open_objects() == 0);
+    // repeated reads reuse the same open dataset
+    std::vector<double> result;
+    for (int i = 0; i < 5; ++i) {
+      ar["data/x"] >> result;
+      REQUIRE(result == std::vector<double>(10, 1.0));
+    }
+    REQUIRE(open_objects() == 1);
+    ar["data"]["x"] >> result;
+    REQUIRE(open_objects() == 1);
+    // writes through cached handle are visible to the next read
+    ar["data/x"] << std::vector<double>(10, 4.0);
+    ar["data/x"] >> result;
+    REQUIRE(result == std::vector<double>(10, 4.0));
+    // least recently used dataset is closed when capacity is exceeded
+    ar["data/y"] >> result;
+    ar["data/z"] >> result;
+    REQUIRE(result == std::vector<double>(3, 3.0));
+    REQUIRE(open_objects() == 2);
+    // cached shape is updated when dataset is resized
+    {
+      auto z = ar["data/z"];
+      z.set_overwrite_policy(green::h5pp::RESIZE_OVERWRITE);
+      z << std::vector<double>(7, 5.0);
+    }
+    ar["data/z"] >> result;
+    REQUIRE(result == std::vector<double>(7, 5.0));
+    // moved links are not served from the cache
+    ar.move("data/y", "data/w");
+    REQUIRE(open_objects() == 0);
+    ar["data/w"] >> result;
+    REQUIRE(result == std::vector<double>(5, 2.0));
+    REQUIRE_THROWS_AS(std::as_const(ar)["data/y"], green::h5pp::hdf5_wrong_path_error);
+    // removed links are not served from the cache
+    ar["data/x"] >> result;
+    ar["data"].unlink("x");
+    REQUIRE(open_objects() == 0);
+    REQUIRE_FALSE(ar.is_data("data/x"));
+    REQUIRE_THROWS_AS(std::as_const(ar)["data/x"] >> result, green::h5pp::hdf5_wrong_path_error);
+    REQUIRE_THROWS_AS(ar.unlink("data/x"), green::h5pp::hdf5_wrong_path_error);
+    REQUIRE_THROWS_AS(ar["data/w"].unlink("x"), green::h5pp::hdf5_wrong_path_error);
+    // content hash written through an evicted handle is seen by the next untracked write through the cache
+    ar["data/v"] << std::vector<double>(2, 0.0);
+    {
+      auto z = ar["data/z"];
+      z >> result;
+      ar["data/w"] >> result;
+      ar["data/v"] >> result;
+      ar["data/z"] >> result;
+      z.set_change_tracking(true);
+      z << std::vector<double>(7, 6.0);
+    }
+    REQUIRE(ar["data/z"].has_attribute("h5pp_hash"));
+    ar["data/z"] << std::vector<double>(7, 8.0);
+    REQUIRE_FALSE(ar["data/z"].has_attribute("h5pp_hash"));
+    ar.set_change_tracking(true);
+    ar["data/z"] << std::vector<double>(7, 9.0);
+    ar.set_change_tracking(false);
+    ar["data/z"] << std::vector<double>(7, 10.0);
+    REQUIRE_FALSE(ar["data/z"].has_attribute("h5pp_hash"));
+    ar.close();
+    REQUIRE_NOTHROW(ar.open(filename, "r", options));
+    ar["data/w"] >> result;
+    REQUIRE(result == std::vector<double>(5, 2.0));
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+  SECTION("Sharded Archive") {
+    std::string filename = TEST_PATH + "/"s + random_name();
+    {
+      green::h5pp::sharded_archive ar(filename, "w", 3);
+      REQUIRE(ar.size() == 3);
+      for (const auto& name : ar.shard_names()) REQUIRE(std::filesystem::exists(TEST_PATH + "/"s + name));
+      for (int i = 0; i < 12; ++i) {
+        ar["G" + std::to_string(i) + "/data"] << std::vector<double>(5, double(i));
+      }
+      ar["/G0/nested/scalar"] << 1.5;
+      // top-level objects are placed by name and spread over the shards
+      std::vector<size_t> used(3, 0);
+      for (int i = 0; i < 12; ++i) {
+        size_t index = ar.shard_index("G" + std::to_string(i) + "/x");
+        REQUIRE(index == ar.shard_index("/G" + std::to_string(i)));
+        REQUIRE(ar.shard(index).is_data("G" + std::to_string(i) + "/data"));
+        ++used[index];
+      }
+      REQUIRE(std::count(used.begin(), used.end(), 0) == 0);
+      // placement is fixed by the placement version of the manifest
+      REQUIRE(ar.shard_index("G0") == 1);
+      REQUIRE(ar.shard_index("G3") == 0);
+      REQUIRE(ar.shard_index("G11") == 2);
+      REQUIRE_THROWS_AS(ar["/"], green::h5pp::hdf5_notsupported_error);
+    }
+    // shards are opened on first access only, so independent writers touch only their own files
+    {
+      green::h5pp::sharded_archive ar(filename, "a");
+      REQUIRE(ar.size() == 3);
+      std::string name;
+      for (int i = 0; name.empty() || ar.shard_index(name) != ar.shard_index("G0"); ++i) name = "H" + std::to_string(i);
+      ar[name] << 2.0;
+      for (size_t i = 0; i < ar.size(); ++i) REQUIRE(ar.is_open(i) == (i == ar.shard_index("G0")));
+      ar.link_shards();
+    }
+    {
+      green::h5pp::sharded_archive ar(filename, "r");
+      std::vector<double>          data;
+      ar["G7/data"] >> data;
+      REQUIRE(data == std::vector<double>(5, 7.0));
+      double scalar;
+      ar["G0/nested/scalar"] >> scalar;
+      REQUIRE(scalar == 1.5);
+      REQUIRE(ar.has_group("G0/nested"));
+      REQUIRE_THROWS_AS(ar.link_shards(), green::h5pp::hdf5_write_error);
+    }
+    // manifest exposes all shards through external links
+    {
+      green::h5pp::archive ar(filename, "r");
+      std::vector<double>  data;
+      ar["G11/data"] >> data;
+      REQUIRE(data == std::vector<double>(5, 11.0));
+      REQUIRE(ar.is_data("G3/data"));
+    }
+    REQUIRE_THROWS_AS(green::h5pp::sharded_archive(TEST_PATH + "/test.h5"s), green::h5pp::hdf5_file_access_error);
+    // manifest with unknown placement is not opened
+    {
+      green::h5pp::archive manifest(filename, "a");
+      manifest.set_attribute("h5pp_placement", 2);
+    }
+    REQUIRE_THROWS_AS(green::h5pp::sharded_archive(filename, "r"), green::h5pp::hdf5_file_access_error);
+    {
+      green::h5pp::archive manifest(filename, "a");
+      manifest.set_attribute("h5pp_placement", 1);
+    }
+    REQUIRE_THROWS_AS(green::h5pp::sharded_archive(TEST_PATH + "/"s + random_name(), "w"), green::h5pp::hdf5_file_access_error);
+    green::h5pp::sharded_archive ar(filename, "r");
+    for (const auto& name : ar.shard_names()) std::filesystem::remove(TEST_PATH + "/"s + name);
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
   SECTION("Close File") {
     std::string          root = TEST_PATH;
     green::h5pp::archive ar(root + "/test.h5");
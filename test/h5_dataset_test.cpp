@@ -3,10 +3,15 @@
  *
  */
 
+#include <algorithm>
 #include <array>
 #include <catch2/catch_test_macros.hpp>
+#include <cmath>
 #include <complex>
+#include <cstdint>
 #include <filesystem>
+#include <memory_resource>
+#include <numeric>
 
 #include "green/h5pp/archive.h"
 #include "test_common.h"
@@ -39,6 +44,40 @@ struct NDArray {
   std::vector<T>        _data;
 };
 
+struct Position {
+  double x;
+  double y;
+  double z;
+};
+
+struct Orbital {
+  double                energy;
+  int                   spin;
+  std::complex<double>  coefficient;
+  Position              center;
+  std::array<double, 3> moments;
+};
+
+// subset of Orbital fields with different order and types
+struct OrbitalEnergy {
+  float energy;
+  long  spin;
+};
+
+H5PP_REGISTER_COMPOUND(Position, H5PP_FIELD(Position, x), H5PP_FIELD(Position, y), H5PP_FIELD(Position, z))
+H5PP_REGISTER_COMPOUND(Orbital, H5PP_FIELD(Orbital, energy), H5PP_FIELD(Orbital, spin), H5PP_FIELD(Orbital, coefficient),
+                       H5PP_FIELD(Orbital, center), H5PP_FIELD(Orbital, moments))
+H5PP_REGISTER_COMPOUND(OrbitalEnergy, H5PP_FIELD(OrbitalEnergy, spin), H5PP_FIELD(OrbitalEnergy, energy))
+
+// two fields registered with the same name
+struct DuplicateField {
+  double a;
+  double b;
+};
+
+H5PP_REGISTER_COMPOUND(DuplicateField, H5PP_FIELD(DuplicateField, a),
+                       green::h5pp::field("a", &DuplicateField::b, offsetof(DuplicateField, b)))
+
 TEST_CASE("Dataset Operations") {
   SECTION("Assign uninitialized objects") {
     std::string          root = TEST_PATH;
@@ -306,6 +345,58 @@ TEST_CASE("Dataset Operations") {
     std::filesystem::remove(std::filesystem::path(filename));
   }
 
+  SECTION("Resize on Overwrite") {
+    std::string          filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::archive ar(filename, "w");
+    std::vector<double>  data(10, 1.0);
+    ar["FIXED"] << data;
+    ar.set_overwrite_policy(green::h5pp::RESIZE_OVERWRITE);
+    auto group = ar["GROUP"];
+    REQUIRE(group.get_overwrite_policy() == green::h5pp::RESIZE_OVERWRITE);
+    group["DATASET"] << data;
+    std::vector<double> result;
+    // non-chunked dataset is created again
+    data.assign(20, 2.0);
+    ar["FIXED"] << data;
+    ar["FIXED"] >> result;
+    REQUIRE(result == data);
+    // resizable dataset is recreated when the rank changes
+    NDArray<double, 2> nd_data(std::array<size_t, 2>{{3, 4}}, 3.0);
+    group["DATASET"] << nd_data;
+    group["DATASET"] << data;
+    group["DATASET"] >> result;
+    REQUIRE(result == data);
+    // dataset of the same rank is resized in place
+    H5O_info_t info_before, info_after;
+    H5Oget_info_by_name(ar.file_id(), "GROUP/DATASET", &info_before, H5P_DEFAULT);
+    group["DATASET"] << std::vector<double>(30, 4.0);
+    H5Oget_info_by_name(ar.file_id(), "GROUP/DATASET", &info_after, H5P_DEFAULT);
+    REQUIRE(info_before.addr == info_after.addr);
+    group["DATASET"] << 5.0;
+    double scalar;
+    group["DATASET"] >> scalar;
+    REQUIRE(std::abs(scalar - 5.0) < 1e-12);
+    // file size stays stable for repeated shape changing updates
+    auto run_iterations = [&](size_t n) {
+      for (size_t i = 0; i < n; ++i) {
+        data.assign(1000 + (i % 7) * 100, double(i));
+        group["ITERATION"] << data;
+        NDArray<double, 2> matrix(std::array<size_t, 2>{{50 + i % 5, 40}}, double(i));
+        group["MATRIX"] << matrix;
+        ar["FIXED"] << matrix;
+      }
+      ar.flush();
+      return std::filesystem::file_size(filename);
+    };
+    auto size_10  = run_iterations(10);
+    auto size_500 = run_iterations(500);
+    REQUIRE(size_500 < 2 * size_10);
+    ar.set_overwrite_policy(green::h5pp::STRICT_OVERWRITE);
+    REQUIRE_THROWS_AS(ar["GROUP/ITERATION"] << nd_data, green::h5pp::hdf5_write_error);
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+
   SECTION("Write Complex Array") {
     std::string                          filename = TEST_PATH + "/"s + random_name();
     green::h5pp::archive                 ar(filename, "w");
@@ -370,6 +461,21 @@ TEST_CASE("Dataset Operations") {
     REQUIRE(std::abs(*data.data() - 0.110326) < 1e-6);
   }
 
+  SECTION("Read Hyperslab") {
+    std::string          filename = TEST_PATH + "/test.h5"s;
+    green::h5pp::archive ar(filename, "r");
+    std::vector<double>  data;
+    std::vector<double>  row(6);
+    ar["GROUP/NDARRAY_DATASET"] >> data;
+    ar["GROUP/NDARRAY_DATASET"].read_hyperslab({3, 0}, {1, 6}, row.data());
+    REQUIRE(std::equal(row.begin(), row.end(), data.begin() + 18));
+    REQUIRE_THROWS_AS(ar["GROUP/NDARRAY_DATASET"].read_hyperslab({10, 0}, {1, 6}, row.data()), green::h5pp::hdf5_read_error);
+    REQUIRE_THROWS_AS(ar["GROUP/NDARRAY_DATASET"].read_hyperslab({0}, {6}, row.data()), green::h5pp::hdf5_read_error);
+    std::complex<double> z[6];
+    REQUIRE_THROWS_AS(ar["GROUP/NDARRAY_DATASET"].read_hyperslab({0, 0}, {1, 6}, z), green::h5pp::hdf5_data_conversion_error);
+    REQUIRE_THROWS_AS(ar["GROUP"].read_hyperslab({0, 0}, {1, 6}, row.data()), green::h5pp::hdf5_not_a_dataset_error);
+  }
+
   SECTION("Write different datatypes") {
     std::string          filename = TEST_PATH + "/"s + random_name();
     green::h5pp::archive ar(filename, "w");
@@ -452,6 +558,629 @@ TEST_CASE("Dataset Operations") {
     std::filesystem::remove(std::filesystem::path(filename));
   }
 
+  SECTION("Append") {
+    std::string          filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::archive ar(filename, "w");
+    for (int i = 0; i < 5; ++i) {
+      ar["SCALARS"].append(double(i));
+    }
+    NDArray<double, 2> nd_data(std::array<size_t, 2>{{2, 3}}, 1.0);
+    ar["RECORDS"].append(nd_data);
+    ar["RECORDS"].append(nd_data);
+    std::vector<double> scalars;
+    ar["SCALARS"] >> scalars;
+    REQUIRE(scalars.size() == 5);
+    REQUIRE(std::abs(scalars[4] - 4.0) < 1e-12);
+    auto shape = green::h5pp::dataset_shape(ar.current_id(), "RECORDS");
+    REQUIRE(shape == std::vector<size_t>{2, 2, 3});
+    NDArray<double, 2> wrong_shape(std::array<size_t, 2>{{3, 3}}, 1.0);
+    REQUIRE_THROWS_AS(ar["RECORDS"].append(wrong_shape), green::h5pp::hdf5_write_error);
+    ar["FIXED"] << nd_data;
+    REQUIRE_THROWS_AS(ar["FIXED"].append(nd_data), green::h5pp::hdf5_write_error);
+    std::stringstream ss;
+    REQUIRE_THROWS_AS(ar["UNSUPPORTED"].append(ss), green::h5pp::hdf5_unsupported_type_error);
+    ar.close();
+    ar.open(filename, "r");
+    REQUIRE_THROWS_AS(ar["SCALARS"].append(1.0), green::h5pp::hdf5_write_error);
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+
+  SECTION("Virtual Dataset") {
+    std::string                              root = TEST_PATH;
+    std::vector<std::string>                 rank_files{random_name(), random_name()};
+    std::vector<green::h5pp::virtual_source> sources;
+    for (size_t rank = 0; rank < rank_files.size(); ++rank) {
+      green::h5pp::archive ar(root + "/" + rank_files[rank], "w");
+      NDArray<double, 2>   block(std::array<size_t, 2>{{2, 3}}, double(rank + 1));
+      ar["BLOCK"] << block;
+      sources.push_back({rank_files[rank], "/BLOCK", {2 * rank, 0}, {2, 3}});
+    }
+    std::string          filename = root + "/"s + random_name();
+    green::h5pp::archive ar(filename, "w");
+    NDArray<double, 2>   local(std::array<size_t, 2>{{1, 3}}, 0.0);
+    std::iota(local._data.begin(), local._data.end(), 7.0);
+    ar["LOCAL/DATA"] << local;
+    sources.push_back({".", "/LOCAL/DATA", {4, 0}, {1, 3}});
+    REQUIRE_THROWS_AS(ar["BAD"].create_virtual<double>({5, 3}, {{".", "/LOCAL/DATA", {4}, {3}}}),
+                      green::h5pp::hdf5_create_dataset_error);
+    REQUIRE_THROWS_AS(ar["BAD"].create_virtual<double>({5, 3}, {{".", "/LOCAL/DATA", {5, 0}, {1, 3}}}),
+                      green::h5pp::hdf5_create_dataset_error);
+    ar["VIRTUAL"].create_virtual<double>({5, 3}, sources);
+    REQUIRE_THROWS_AS(ar["VIRTUAL"].create_virtual<double>({5, 3}, sources), green::h5pp::hdf5_create_dataset_error);
+    ar.close();
+    ar.open(filename, "r");
+    NDArray<double, 2> result;
+    ar["VIRTUAL"] >> result;
+    REQUIRE(result.shape() == std::array<size_t, 2>{{5, 3}});
+    REQUIRE(std::abs(result.data()[0] - 1.0) < 1e-12);
+    REQUIRE(std::abs(result.data()[8] - 2.0) < 1e-12);
+    REQUIRE(std::abs(result.data()[14] - 9.0) < 1e-12);
+    REQUIRE_THROWS_AS(ar["NEW"].create_virtual<double>({5, 3}, sources), green::h5pp::hdf5_wrong_path_error);
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+    for (const auto& rank_file : rank_files) std::filesystem::remove(std::filesystem::path(root + "/" + rank_file));
+  }
+
+  SECTION("Compressed Write") {
+    std::string          filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::archive ar(filename, "w");
+    // 1003 rows do not fit into chunks of 64 rows evenly
+    NDArray<double, 2>   data(std::array<size_t, 2>{{1003, 7}}, 0.0);
+    for (size_t i = 0; i < data.size(); ++i) data.data()[i] = std::sin(0.01 * i);
+    ar["GROUP/MATRIX"].write_compressed(data, {6, true, 64, 4});
+    std::vector<std::complex<double>> cdata(5000);
+    for (size_t i = 0; i < cdata.size(); ++i) cdata[i] = std::complex<double>(i % 13, -double(i % 5));
+    ar["COMPLEX"].write_compressed(cdata, {1, false, 0, 0});
+    REQUIRE_THROWS_AS(ar["GROUP"].write_compressed(cdata), green::h5pp::hdf5_not_a_dataset_error);
+    ar["PLAIN"] << cdata;
+    REQUIRE_THROWS_AS(ar["PLAIN"].write_compressed(cdata), green::h5pp::hdf5_write_error);
+    // invalid compression level is rejected before the dataset is created
+    REQUIRE_THROWS_AS(ar["INVALID"].write_compressed(cdata, {10, false, 0, 0}), green::h5pp::hdf5_create_dataset_error);
+    REQUIRE_FALSE(ar.is_data("INVALID"));
+    ar.close();
+    ar.open(filename, "a");
+    NDArray<double, 2> result(std::array<size_t, 2>{{1003, 7}}, 1.0);
+    ar["GROUP/MATRIX"] >> result;
+    REQUIRE(std::equal(data.data(), data.data() + data.size(), result.data()));
+    std::fill(result.data(), result.data() + result.size(), 1.0);
+    ar["GROUP/MATRIX"].read_compressed(result, 3);
+    REQUIRE(std::equal(data.data(), data.data() + data.size(), result.data()));
+    std::vector<std::complex<double>> cresult;
+    ar["COMPLEX"].read_compressed(cresult);
+    REQUIRE(cresult == cdata);
+    // datasets that can not be read chunk by chunk are read as usual
+    cresult.clear();
+    ar["PLAIN"].read_compressed(cresult);
+    REQUIRE(cresult == cdata);
+    // existing compressed dataset is overwritten in place
+    std::reverse(cdata.begin(), cdata.end());
+    ar["COMPLEX"].write_compressed(cdata);
+    ar["COMPLEX"] >> cresult;
+    REQUIRE(cresult == cdata);
+    // chunks that have not been written contain fill value of the dataset
+    hsize_t dims = 16, chunk = 4, count = 4, start = 0;
+    double  fill = -1.5;
+    hid_t   dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(dcpl, 1, &chunk);
+    H5Pset_deflate(dcpl, 4);
+    H5Pset_fill_value(dcpl, H5T_NATIVE_DOUBLE, &fill);
+    hid_t space_id = H5Screate_simple(1, &dims, NULL);
+    hid_t d_id     = H5Dcreate2(ar.file_id(), "SPARSE_CHUNKS", H5T_NATIVE_DOUBLE, space_id, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    hid_t mem_id   = H5Screate_simple(1, &count, NULL);
+    H5Sselect_hyperslab(space_id, H5S_SELECT_SET, &start, NULL, &count, NULL);
+    std::vector<double> written(4, 2.0);
+    H5Dwrite(d_id, H5T_NATIVE_DOUBLE, mem_id, space_id, H5P_DEFAULT, written.data());
+    H5Sclose(mem_id);
+    H5Sclose(space_id);
+    H5Dclose(d_id);
+    H5Pclose(dcpl);
+    std::vector<double> sparse_result;
+    ar["SPARSE_CHUNKS"].read_compressed(sparse_result, 2);
+    REQUIRE(sparse_result.size() == 16);
+    REQUIRE(std::all_of(sparse_result.begin(), sparse_result.begin() + 4, [](double x) { return x == 2.0; }));
+    REQUIRE(std::all_of(sparse_result.begin() + 4, sparse_result.end(), [](double x) { return x == -1.5; }));
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+
+  SECTION("Aligned Buffer") {
+    std::string          filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::archive ar(filename, "w");
+    NDArray<double, 2>   data(std::array<size_t, 2>{{5, 3}}, 0.0);
+    for (size_t i = 0; i < data.size(); ++i) data.data()[i] = i;
+    ar["MATRIX"] << data;
+    ar["SCALAR"] << 1.0;
+    auto buffer = ar["MATRIX"].read<double>();
+    REQUIRE(reinterpret_cast<std::uintptr_t>(buffer.data()) % 64 == 0);
+    REQUIRE(buffer.shape() == std::vector<size_t>{5, 3});
+    REQUIRE(std::equal(buffer.begin(), buffer.end(), data.data()));
+    // existing buffer is reused
+    green::h5pp::ndbuffer<float, green::h5pp::aligned_allocator<float, 128>> fbuffer({2, 2});
+    ar["MATRIX"] >> fbuffer;
+    REQUIRE(reinterpret_cast<std::uintptr_t>(fbuffer.data()) % 128 == 0);
+    REQUIRE(fbuffer.shape() == std::vector<size_t>{5, 3});
+    REQUIRE(std::abs(fbuffer[14] - 14.0f) < 1e-6);
+    // memory from user provided arena
+    std::array<std::byte, 4096>         storage;
+    std::pmr::monotonic_buffer_resource arena(storage.data(), storage.size(), std::pmr::null_memory_resource());
+    auto arena_buffer = ar["MATRIX"].read<double, std::pmr::polymorphic_allocator<double>>(&arena);
+    REQUIRE(reinterpret_cast<std::byte*>(arena_buffer.data()) >= storage.data());
+    REQUIRE(reinterpret_cast<std::byte*>(arena_buffer.data()) < storage.data() + storage.size());
+    REQUIRE(std::equal(arena_buffer.begin(), arena_buffer.end(), data.data()));
+    // written back as a regular N-dimensional array
+    ar["COPY"] << buffer;
+    REQUIRE(green::h5pp::dataset_shape(ar.current_id(), "COPY") == std::vector<size_t>{5, 3});
+    ar["SCALAR"] >> buffer;
+    REQUIRE(buffer.size() == 1);
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+
+  SECTION("Write from Raw Pointer") {
+    std::string          filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::archive ar(filename, "w");
+    std::vector<double>  external(24);
+    std::iota(external.begin(), external.end(), 0.0);
+    ar["TENSOR"].write(external.data(), {2, 3, 4});
+    REQUIRE(green::h5pp::dataset_shape(ar.current_id(), "TENSOR") == std::vector<size_t>{2, 3, 4});
+    // existing dataset is updated in place
+    external[5] = -1.0;
+    ar["TENSOR"].write(external.data(), {2, 3, 4});
+    REQUIRE_THROWS_AS(ar["TENSOR"].write(external.data(), {4, 6}), green::h5pp::hdf5_write_error);
+    const std::vector<std::complex<double>> cexternal(6, {1.0, 2.0});
+    ar["COMPLEX"] << green::h5pp::array_view<const std::complex<double>>(cexternal.data(), {6});
+    ar["SCALAR"].write(external.data(), {});
+    std::vector<double> result;
+    ar["TENSOR"] >> result;
+    REQUIRE(result == external);
+    std::vector<std::complex<double>> cresult;
+    ar["COMPLEX"] >> cresult;
+    REQUIRE(cresult == cexternal);
+    double scalar;
+    ar["SCALAR"] >> scalar;
+    REQUIRE(scalar == 0.0);
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+
+  SECTION("Shape Buffers") {
+    REQUIRE(green::h5pp::internal::static_rank<NDArray<double, 3>>::value == 3);
+    REQUIRE(green::h5pp::internal::static_rank<green::h5pp::ndbuffer<double>>::value == -1);
+    auto [rank, dims] = green::h5pp::internal::extract_dataset_shape(NDArray<double, 3>(std::array<size_t, 3>{{2, 3, 4}}, 0.0));
+    REQUIRE(rank == 3);
+    REQUIRE(std::is_same_v<decltype(dims), std::array<size_t, 3>>);
+    green::h5pp::internal::shape_buffer<hsize_t> buffer(2, 5);
+    buffer.push_back(7);
+    REQUIRE(green::h5pp::internal::same_shape(buffer, std::vector<size_t>{5, 5, 7}));
+    REQUIRE(green::h5pp::internal::shape_size(buffer) == 175);
+    REQUIRE_THROWS_AS(buffer.resize(H5S_MAX_RANK + 1), green::h5pp::hdf5_notsupported_error);
+  }
+
+  SECTION("Compound Types") {
+    std::string          filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::archive ar(filename, "w");
+    std::vector<Orbital> orbitals(10);
+    for (size_t i = 0; i < orbitals.size(); ++i) {
+      orbitals[i] = Orbital{-1.0 * i, int(i % 2), {1.0, -double(i)}, {0.5 * i, 0.0, 1.0}, {{1.0, 2.0, double(i)}}};
+    }
+    ar["ORBITALS"] << orbitals;
+    ar["ORBITAL"] << orbitals[3];
+    ar["PLAIN"] << std::vector<double>(10, 1.0);
+    // incomplete compound type is not created
+    REQUIRE_THROWS_AS(ar["DUPLICATE"] << (DuplicateField{1.0, 2.0}), green::h5pp::hdf5_unsupported_type_error);
+    REQUIRE_FALSE(ar.is_data("DUPLICATE"));
+    ar.close();
+    ar.open(filename, "r");
+    std::vector<Orbital> result;
+    ar["ORBITALS"] >> result;
+    REQUIRE(result.size() == orbitals.size());
+    for (size_t i = 0; i < orbitals.size(); ++i) {
+      REQUIRE(result[i].energy == orbitals[i].energy);
+      REQUIRE(result[i].spin == orbitals[i].spin);
+      REQUIRE(result[i].coefficient == orbitals[i].coefficient);
+      REQUIRE(result[i].center.x == orbitals[i].center.x);
+      REQUIRE(result[i].moments == orbitals[i].moments);
+    }
+    Orbital orbital;
+    ar["ORBITAL"] >> orbital;
+    REQUIRE(orbital.coefficient == orbitals[3].coefficient);
+    REQUIRE(orbital.center.x == orbitals[3].center.x);
+    // subset of fields is matched by name
+    std::vector<OrbitalEnergy> energies;
+    ar["ORBITALS"] >> energies;
+    REQUIRE(energies.size() == orbitals.size());
+    REQUIRE(std::abs(energies[7].energy + 7.0f) < 1e-6);
+    REQUIRE(energies[7].spin == 1);
+    // single field
+    std::vector<double> energy;
+    ar["ORBITALS"].read_field("energy", energy);
+    REQUIRE(energy.size() == orbitals.size());
+    REQUIRE(std::abs(energy[4] + 4.0) < 1e-12);
+    std::vector<std::complex<double>> coefficients;
+    ar["ORBITALS"].read_field("coefficient", coefficients);
+    REQUIRE(coefficients[5] == std::complex<double>(1.0, -5.0));
+    std::vector<Position> centers;
+    ar["ORBITALS"].read_field("center", centers);
+    REQUIRE(centers[6].x == 3.0);
+    int spin;
+    ar["ORBITAL"].read_field("spin", spin);
+    REQUIRE(spin == 1);
+    REQUIRE_THROWS_AS(ar["ORBITALS"].read_field("occupation", energy), green::h5pp::hdf5_read_error);
+    REQUIRE_THROWS_AS(ar["PLAIN"].read_field("energy", energy), green::h5pp::hdf5_read_error);
+    REQUIRE_THROWS_AS(ar["ORBITALS"].read_field("center", energy), green::h5pp::hdf5_data_conversion_error);
+    // content hash does not depend on struct padding
+    auto fill_members = [&](Orbital& dst, unsigned char padding) {
+      std::memset(static_cast<void*>(&dst), padding, sizeof(dst));
+      dst.energy      = orbitals[3].energy;
+      dst.spin        = orbitals[3].spin;
+      dst.coefficient = orbitals[3].coefficient;
+      dst.center      = orbitals[3].center;
+      dst.moments     = orbitals[3].moments;
+    };
+    Orbital padded;
+    fill_members(padded, 0xFF);
+    fill_members(orbital, 0x00);
+    REQUIRE(std::memcmp(&padded, &orbital, sizeof(Orbital)) != 0);
+    REQUIRE(green::h5pp::internal::content_hash(padded) == green::h5pp::internal::content_hash(orbital));
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+
+  SECTION("Sparse Matrices") {
+    std::string          filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::archive ar(filename, "w");
+    // 5x4 matrix with empty rows 1 and 3
+    green::h5pp::csr_matrix<std::complex<double>> csr;
+    csr.shape   = {{5, 4}};
+    csr.indptr  = {0, 2, 2, 3, 3, 5};
+    csr.indices = {0, 3, 1, 0, 2};
+    csr.values  = {{1.0, 1.0}, {2.0, -1.0}, {3.0, 0.0}, {4.0, 2.0}, {5.0, 0.5}};
+    ar["SPARSE/CSR"] << csr;
+    green::h5pp::csr_matrix<std::complex<double>> csr_result;
+    ar["SPARSE/CSR"] >> csr_result;
+    REQUIRE(csr_result.shape == csr.shape);
+    REQUIRE(csr_result.indptr == csr.indptr);
+    REQUIRE(csr_result.indices == csr.indices);
+    REQUIRE(csr_result.values == csr.values);
+    // rows 1..3 contain single non-zero element
+    ar["SPARSE/CSR"].read_rows(1, 3, csr_result);
+    REQUIRE(csr_result.shape == std::array<size_t, 2>{{3, 4}});
+    REQUIRE(csr_result.indptr == std::vector<int64_t>{0, 0, 1, 1});
+    REQUIRE(csr_result.indices == std::vector<int64_t>{1});
+    REQUIRE(csr_result.values[0] == std::complex<double>(3.0, 0.0));
+    ar["SPARSE/CSR"].read_rows(3, 0, csr_result);
+    REQUIRE(csr_result.nnz() == 0);
+    REQUIRE(csr_result.indptr.size() == 1);
+    REQUIRE_THROWS_AS(ar["SPARSE/CSR"].read_rows(4, 2, csr_result), green::h5pp::hdf5_read_error);
+    // unsorted coordinates are sorted on write
+    green::h5pp::coo_matrix<double, int> coo;
+    coo.shape  = {{3, 3}};
+    coo.row    = {2, 0, 2, 0};
+    coo.col    = {1, 2, 0, 0};
+    coo.values = {4.0, 2.0, 3.0, 1.0};
+    ar["SPARSE/COO"] << coo;
+    green::h5pp::coo_matrix<double, int> coo_result;
+    ar["SPARSE/COO"] >> coo_result;
+    REQUIRE(coo_result.row == std::vector<int>{0, 0, 2, 2});
+    REQUIRE(coo_result.col == std::vector<int>{0, 2, 0, 1});
+    REQUIRE(coo_result.values == std::vector<double>{1.0, 2.0, 3.0, 4.0});
+    ar["SPARSE/COO"].read_rows(1, 2, coo_result);
+    REQUIRE(coo_result.shape == std::array<size_t, 2>{{2, 3}});
+    REQUIRE(coo_result.row == std::vector<int>{1, 1});
+    REQUIRE(coo_result.col == std::vector<int>{0, 1});
+    // format mismatch
+    REQUIRE_THROWS_AS(ar["SPARSE/COO"] >> csr_result, green::h5pp::hdf5_read_error);
+    REQUIRE_THROWS_AS(ar["SPARSE"] >> csr_result, green::h5pp::hdf5_read_error);
+    REQUIRE_THROWS_AS(ar["SPARSE"] << csr, green::h5pp::hdf5_write_error);
+    coo.row[0] = 3;
+    REQUIRE_THROWS_AS(ar["SPARSE/BAD"] << coo, green::h5pp::hdf5_write_error);
+    csr.indptr.pop_back();
+    REQUIRE_THROWS_AS(ar["SPARSE/BAD"] << csr, green::h5pp::hdf5_write_error);
+    // overwrite with matrix with different number of non-zeros
+    csr.indptr = {0, 1, 1, 1, 1, 1};
+    csr.indices.resize(1);
+    csr.values.resize(1);
+    ar["SPARSE/CSR"] << csr;
+    ar["SPARSE/CSR"] >> csr_result;
+    REQUIRE(csr_result.nnz() == 1);
+    REQUIRE(csr_result.indptr == csr.indptr);
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+
+  SECTION("Block-Sparse Tensors") {
+    std::string                                                  filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::archive                                         ar(filename, "w");
+    green::h5pp::block_sparse_tensor<std::complex<double>>       tensor;
+    // blocks of different rank and size, e.g. labeled by irrep and spin
+    auto b0 = tensor.add_block(10, {2, 3});
+    for (size_t i = 0; i < b0.size(); ++i) b0[i] = std::complex<double>(i, -1.0 * i);
+    tensor.add_block(11, {0, 4});
+    auto b2 = tensor.add_block(20, {2, 2, 2});
+    for (size_t i = 0; i < b2.size(); ++i) b2[i] = std::complex<double>(100.0 + i, 0.5);
+    REQUIRE_THROWS_AS(tensor.add_block(20, {1}), green::h5pp::hdf5_write_error);
+    REQUIRE(tensor.values().size() == 14);
+    ar["BLOCKS"] << tensor;
+    green::h5pp::block_sparse_tensor<std::complex<double>> result;
+    ar["BLOCKS"] >> result;
+    REQUIRE(result.blocks().size() == 3);
+    REQUIRE(result.values() == tensor.values());
+    REQUIRE(result.block(20).shape() == std::vector<size_t>{2, 2, 2});
+    REQUIRE(result.block(10)[4] == std::complex<double>(4.0, -4.0));
+    REQUIRE(result.block(11).size() == 0);
+    REQUIRE_THROWS_AS(result.block(12), green::h5pp::hdf5_read_error);
+    // single block is read by key
+    green::h5pp::ndbuffer<std::complex<double>> block;
+    ar["BLOCKS"].read_block(20, block);
+    REQUIRE(block.shape() == std::vector<size_t>{2, 2, 2});
+    REQUIRE(block[7] == std::complex<double>(107.0, 0.5));
+    std::vector<std::complex<double>> flat;
+    ar["BLOCKS"].read_block(10, flat);
+    REQUIRE(flat.size() == 6);
+    REQUIRE(flat[5] == std::complex<double>(5.0, -5.0));
+    std::array<std::complex<double>, 4> fixed;
+    REQUIRE_THROWS_AS(ar["BLOCKS"].read_block(10, fixed), green::h5pp::hdf5_read_error);
+    REQUIRE_THROWS_AS(ar["BLOCKS"].read_block(30, flat), green::h5pp::hdf5_read_error);
+    // format mismatch
+    green::h5pp::csr_matrix<double> csr;
+    REQUIRE_THROWS_AS(ar["BLOCKS"] >> csr, green::h5pp::hdf5_read_error);
+    // overwrite
+    tensor.clear();
+    tensor.add_block(1, {3})[2] = 1.0;
+    ar["BLOCKS"] << tensor;
+    ar["BLOCKS"] >> result;
+    REQUIRE(result.blocks().size() == 1);
+    REQUIRE(result.block(1)[2] == 1.0);
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+
+  SECTION("Deduplication") {
+    std::string          filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::archive ar(filename, "w");
+    ar.set_deduplication(true);
+    std::vector<double> grid(10000);
+    std::iota(grid.begin(), grid.end(), 0.0);
+    for (int it = 0; it < 5; ++it) {
+      ar["ITER" + std::to_string(it) + "/GRID"] << grid;
+      ar["ITER" + std::to_string(it) + "/ENERGY"] << std::vector<double>{-1.0 * it};
+    }
+    H5O_info_t info_0, info_4;
+    H5Oget_info_by_name(ar.file_id(), "ITER0/GRID", &info_0, H5P_DEFAULT);
+    H5Oget_info_by_name(ar.file_id(), "ITER4/GRID", &info_4, H5P_DEFAULT);
+    REQUIRE(info_0.addr == info_4.addr);
+    // 5 iterations and the index entry
+    REQUIRE(info_0.rc == 6);
+    H5Oget_info_by_name(ar.file_id(), "ITER1/ENERGY", &info_0, H5P_DEFAULT);
+    H5Oget_info_by_name(ar.file_id(), "ITER2/ENERGY", &info_4, H5P_DEFAULT);
+    REQUIRE(info_0.addr != info_4.addr);
+    // same content with different shape or type is stored separately
+    ar["RESHAPED"] << green::h5pp::array_view<const double>(grid.data(), {100, 100});
+    std::vector<float> grid_float(grid.begin(), grid.end());
+    ar["FLOAT"] << grid_float;
+    H5Oget_info_by_name(ar.file_id(), "RESHAPED", &info_4, H5P_DEFAULT);
+    REQUIRE(info_4.rc == 2);
+    H5Oget_info_by_name(ar.file_id(), "FLOAT", &info_4, H5P_DEFAULT);
+    REQUIRE(info_4.rc == 2);
+    // update of a shared dataset does not change other paths
+    std::vector<double> result;
+    ar["ITER3/GRID"] << std::vector<double>(10000, 1.0);
+    ar["ITER3/GRID"] >> result;
+    REQUIRE(result == std::vector<double>(10000, 1.0));
+    ar["ITER2/GRID"] >> result;
+    REQUIRE(result == grid);
+    H5Oget_info_by_name(ar.file_id(), "ITER0/GRID", &info_0, H5P_DEFAULT);
+    REQUIRE(info_0.rc == 5);
+    // dataset that is not shared is updated in place and re-registered, old content is not kept by the index
+    H5G_info_t index_info;
+    H5Gget_info_by_name(ar.file_id(), "/.h5pp_dedup", &index_info, H5P_DEFAULT);
+    hsize_t index_size = index_info.nlinks;
+    ar.flush();
+    auto file_size = std::filesystem::file_size(filename);
+    for (int it = 0; it < 50; ++it) {
+      ar["ENERGY"] << std::vector<double>(1000, double(it));
+    }
+    ar.flush();
+    H5Gget_info_by_name(ar.file_id(), "/.h5pp_dedup", &index_info, H5P_DEFAULT);
+    REQUIRE(index_info.nlinks == index_size + 1);
+    REQUIRE(std::filesystem::file_size(filename) < file_size + 2 * 8000 + 4096);
+    H5Oget_info_by_name(ar.file_id(), "ENERGY", &info_4, H5P_DEFAULT);
+    REQUIRE(info_4.rc == 2);
+    // new content that is already stored is shared
+    ar["ENERGY"] << grid;
+    H5Oget_info_by_name(ar.file_id(), "ENERGY", &info_4, H5P_DEFAULT);
+    REQUIRE(info_4.rc == 6);
+    H5Gget_info_by_name(ar.file_id(), "/.h5pp_dedup", &index_info, H5P_DEFAULT);
+    REQUIRE(index_info.nlinks == index_size);
+    // datasets written without deduplication are not shared
+    ar.set_deduplication(false);
+    ar["PLAIN"] << grid;
+    H5Oget_info_by_name(ar.file_id(), "PLAIN", &info_4, H5P_DEFAULT);
+    REQUIRE(info_4.rc == 1);
+    // in-place update of a shared dataset removes its index entry, so the hash can be registered again
+    ar["ITER4/GRID"] << std::vector<double>(10000, 2.0);
+    H5Oget_info_by_name(ar.file_id(), "ITER0/GRID", &info_0, H5P_DEFAULT);
+    REQUIRE(info_0.rc == 5);
+    ar.set_deduplication(true);
+    ar["NEW_GRID"] << grid;
+    H5Oget_info_by_name(ar.file_id(), "NEW_GRID", &info_4, H5P_DEFAULT);
+    REQUIRE(info_4.rc == 2);
+    // structs with the same members and different padding are shared
+    std::vector<Orbital> orbitals_a(3), orbitals_b(3);
+    std::memset(static_cast<void*>(orbitals_a.data()), 0x00, 3 * sizeof(Orbital));
+    std::memset(static_cast<void*>(orbitals_b.data()), 0xFF, 3 * sizeof(Orbital));
+    for (size_t i = 0; i < 3; ++i) {
+      for (auto* orbital : {&orbitals_a[i], &orbitals_b[i]}) {
+        orbital->energy      = -1.0 * i;
+        orbital->spin        = int(i);
+        orbital->coefficient = {1.0, 2.0};
+        orbital->center      = {0.0, 1.0, 2.0};
+        orbital->moments     = {{3.0, 4.0, 5.0}};
+      }
+    }
+    ar["ORBITALS_A"] << orbitals_a;
+    ar["ORBITALS_B"] << orbitals_b;
+    H5Oget_info_by_name(ar.file_id(), "ORBITALS_A", &info_0, H5P_DEFAULT);
+    H5Oget_info_by_name(ar.file_id(), "ORBITALS_B", &info_4, H5P_DEFAULT);
+    REQUIRE(info_0.addr == info_4.addr);
+    // index entry is removed together with the last link to the dataset
+    ar["COPY"] << grid;
+    H5Gget_info_by_name(ar.file_id(), "/.h5pp_dedup", &index_info, H5P_DEFAULT);
+    index_size = index_info.nlinks;
+    ar.unlink("NEW_GRID");
+    H5Gget_info_by_name(ar.file_id(), "/.h5pp_dedup", &index_info, H5P_DEFAULT);
+    REQUIRE(index_info.nlinks == index_size);
+    ar["COPY"] >> result;
+    REQUIRE(result == grid);
+    ar.unlink("COPY");
+    H5Gget_info_by_name(ar.file_id(), "/.h5pp_dedup", &index_info, H5P_DEFAULT);
+    REQUIRE(index_info.nlinks == index_size - 1);
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+
+  SECTION("Streaming Reductions") {
+    std::string          filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::archive ar(filename, "w");
+    NDArray<double, 2>   data({1000, 7}, 0.0);
+    NDArray<double, 2>   next({1000, 7}, 0.0);
+    std::iota(data._data.begin(), data._data.end(), -100.0);
+    std::transform(data._data.begin(), data._data.end(), next._data.begin(), [](double x) { return x + 0.5; });
+    ar["DATA"] << data;
+    ar["NEXT"].write_compressed(next, green::h5pp::compression_options{4, true, 64, 2});
+    double sum  = std::accumulate(data._data.begin(), data._data.end(), 0.0);
+    double norm = std::sqrt(std::inner_product(data._data.begin(), data._data.end(), data._data.begin(), 0.0));
+    // blocks are smaller than the dataset and do not divide it evenly
+    for (size_t budget : {size_t(1), size_t(8 * 7 * 3), green::h5pp::internal::default_block_bytes}) {
+      REQUIRE(std::abs(ar["DATA"].sum(budget) - sum) < 1e-9 * std::abs(sum));
+      REQUIRE(ar["DATA"].minmax(budget) == std::make_pair(-100.0, 6899.0));
+      REQUIRE(std::abs(ar["DATA"].norm(budget) - norm) < 1e-9 * norm);
+      REQUIRE(std::abs(ar["DATA"].diff_norm(ar["NEXT"], budget) - 0.5 * std::sqrt(7000.0)) < 1e-9);
+      REQUIRE(std::abs(ar["NEXT"].diff_norm(next, budget)) == 0.0);
+    }
+    REQUIRE(ar["DATA"].minmax<int>() == std::make_pair(-100, 6899));
+    // chunked datasets are read in chunk-aligned blocks
+    green::h5pp::internal::shape_buffer<hsize_t> dims(2);
+    dims[0] = 1000;
+    dims[1] = 7;
+    REQUIRE(green::h5pp::internal::aligned_block_shape(ar["NEXT"].current_id(), dims, 0, sizeof(double), 8 * 7 * 100) ==
+            std::vector<size_t>{64, 7});
+    REQUIRE(green::h5pp::internal::aligned_block_shape(ar["NEXT"].current_id(), dims, 0, sizeof(double), 8 * 7 * 150) ==
+            std::vector<size_t>{128, 7});
+    REQUIRE(green::h5pp::internal::aligned_block_shape(ar["DATA"].current_id(), dims, 0, sizeof(double), 8 * 7 * 100) ==
+            std::vector<size_t>{100, 7});
+    // chunk that does not fit into the budget is read in parts
+    REQUIRE(green::h5pp::internal::aligned_block_shape(ar["NEXT"].current_id(), dims, 0, sizeof(double), 8 * 7 * 10) ==
+            std::vector<size_t>{10, 7});
+    // slab that does not fit into the budget is split along the remaining axes
+    REQUIRE(green::h5pp::internal::aligned_block_shape(ar["DATA"].current_id(), dims, 0, sizeof(double), 8 * 5) ==
+            std::vector<size_t>{1, 5});
+    REQUIRE(green::h5pp::internal::aligned_block_shape(ar["DATA"].current_id(), dims, 1, sizeof(double), 8 * 500) ==
+            std::vector<size_t>{500, 1});
+    REQUIRE(green::h5pp::internal::aligned_block_shape(ar["DATA"].current_id(), dims, 0, sizeof(double), 1) ==
+            std::vector<size_t>{1, 1});
+    std::vector<std::complex<double>> z{{3.0, 4.0}, {0.0, 1.0}};
+    ar["Z"] << z;
+    REQUIRE(ar["Z"].sum<std::complex<double>>() == std::complex<double>(3.0, 5.0));
+    REQUIRE(std::abs(ar["Z"].norm<std::complex<double>>() - std::sqrt(26.0)) < 1e-12);
+    REQUIRE(ar["Z"].diff_norm(z) == 0.0);
+    ar["SCALAR"] << 2.5;
+    REQUIRE(ar["SCALAR"].sum() == 2.5);
+    ar["EMPTY"] << std::vector<double>();
+    REQUIRE(ar["EMPTY"].sum() == 0.0);
+    REQUIRE_THROWS_AS(ar["EMPTY"].minmax(), green::h5pp::hdf5_read_error);
+    // NaN is propagated wherever it occurs
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    ar["NAN_FIRST"] << std::vector<double>{nan, 1.0, 2.0};
+    ar["NAN_LAST"] << std::vector<double>{1.0, 2.0, nan};
+    for (const char* name : {"NAN_FIRST", "NAN_LAST"}) {
+      auto [lo, hi] = ar[name].minmax(sizeof(double));
+      REQUIRE(std::isnan(lo));
+      REQUIRE(std::isnan(hi));
+    }
+    // integers are summed without overflow
+    ar["LARGE_INT"] << std::vector<int>(4, std::numeric_limits<int>::max());
+    REQUIRE(ar["LARGE_INT"].sum<int>() == 4ll * std::numeric_limits<int>::max());
+    REQUIRE_THROWS_AS(ar["DATA"].diff_norm(ar["Z"]), green::h5pp::hdf5_read_error);
+    REQUIRE_THROWS_AS(ar["DATA"].diff_norm(z), green::h5pp::hdf5_read_error);
+    REQUIRE_THROWS_AS(ar["GROUP"].sum(), green::h5pp::hdf5_not_a_dataset_error);
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+
+  SECTION("Block Iterator") {
+    std::string          filename = TEST_PATH + "/"s + random_name();
+    green::h5pp::archive ar(filename, "w");
+    NDArray<int, 3>      data({10, 4, 3}, 0);
+    std::iota(data._data.begin(), data._data.end(), 0);
+    ar["DATA"] << data;
+    // blocks along the leading dimension are contiguous parts of the dataset
+    std::vector<int> result;
+    std::vector<int> offsets;
+    auto             blocks = ar["DATA"].blocks<int>(0, 4 * 4 * 3 * sizeof(int));
+    REQUIRE(blocks.block_extent() == 4);
+    REQUIRE(blocks.size() == 3);
+    for (const auto& block : blocks) {
+      REQUIRE(block.view.shape() == std::vector<size_t>{std::min<size_t>(4, 10 - block.offset), 4, 3});
+      offsets.push_back(int(block.offset));
+      result.insert(result.end(), block.view.begin(), block.view.end());
+    }
+    REQUIRE(offsets == std::vector<int>{0, 4, 8});
+    REQUIRE(result == data._data);
+    // range can be iterated again
+    REQUIRE(std::distance(blocks.begin(), blocks.end()) == 3);
+    // blocks along inner axis
+    result.clear();
+    for (const auto& block : ar["DATA"].blocks<int>(1, 10 * 3 * sizeof(int))) {
+      REQUIRE(block.view.shape() == std::vector<size_t>{10, 1, 3});
+      for (size_t i = 0; i < 10; ++i) {
+        for (size_t k = 0; k < 3; ++k) REQUIRE(block.view[i * 3 + k] == data._data[(i * 4 + block.offset) * 3 + k]);
+      }
+      result.push_back(block.view[0]);
+    }
+    REQUIRE(result == std::vector<int>{0, 3, 6, 9});
+    // slabs larger than the budget are read in parts, blocks along the leading axis stay in row-major order
+    result.clear();
+    offsets.clear();
+    auto parts = ar["DATA"].blocks<int>(0, 5 * sizeof(int));
+    REQUIRE(parts.block_shape() == std::vector<size_t>{1, 1, 3});
+    REQUIRE(parts.size() == 40);
+    for (const auto& block : parts) {
+      REQUIRE(block.view.size() * sizeof(int) <= 5 * sizeof(int));
+      REQUIRE(block.origin == std::vector<size_t>{block.offset, size_t(offsets.size() % 4), 0});
+      offsets.push_back(int(block.offset));
+      result.insert(result.end(), block.view.begin(), block.view.end());
+    }
+    REQUIRE(result == data._data);
+    REQUIRE(ar["DATA"].sum<int>(5 * sizeof(int)) == std::accumulate(data._data.begin(), data._data.end(), 0));
+    result.clear();
+    for (const auto& block : ar["DATA"].blocks<int>(2, 7 * sizeof(int))) {
+      REQUIRE(block.view.shape() == std::vector<size_t>{1, std::min<size_t>(7, 4), 1});
+      result.push_back(block.view[0]);
+    }
+    REQUIRE(result.size() == 30);
+    REQUIRE(result[0] == 0);
+    REQUIRE(result[1] == 12);
+    REQUIRE(result[10] == 1);
+    // blocks of chunked dataset are chunk-aligned
+    ar["CHUNKED"].write_compressed(data, green::h5pp::compression_options{4, true, 3, 1});
+    REQUIRE(ar["CHUNKED"].blocks<int>(0, 5 * 4 * 3 * sizeof(int)).block_extent() == 3);
+    REQUIRE(ar["CHUNKED"].blocks<int>(0, 7 * 4 * 3 * sizeof(int)).block_extent() == 6);
+    ar["SCALAR"] << 2.5;
+    size_t count = 0;
+    for (const auto& block : ar["SCALAR"].blocks()) {
+      REQUIRE(block.view.size() == 1);
+      REQUIRE(block.view[0] == 2.5);
+      ++count;
+    }
+    REQUIRE(count == 1);
+    ar["EMPTY"] << std::vector<double>();
+    REQUIRE(ar["EMPTY"].blocks().begin() == ar["EMPTY"].blocks().end());
+    REQUIRE_THROWS_AS(ar["DATA"].blocks<int>(3), green::h5pp::hdf5_read_error);
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+
   SECTION("Obtain shape") {
     std::string            filename = TEST_PATH + "/test.h5"s;
     green::h5pp::archive   ar(filename, "r");
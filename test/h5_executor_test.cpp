@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+
+#include "green/h5pp/prefetcher.h"
+#include "test_common.h"
+
+TEST_CASE("Executor") {
+  SECTION("Concurrent Write and Read") {
+    std::string filename = TEST_PATH + "/"s + random_name();
+    {
+      green::h5pp::io_executor executor(filename, "w");
+      std::vector<std::thread> workers;
+      for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&executor, t]() {
+          std::vector<std::future<void>> futures;
+          for (int i = 0; i < 10; ++i) {
+            std::vector<double> data(16, t * 100 + i);
+            futures.push_back(executor.write("THREAD_" + std::to_string(t) + "/DATA_" + std::to_string(i), std::move(data)));
+          }
+          for (auto& f : futures) f.get();
+        });
+      }
+      for (auto& w : workers) w.join();
+      std::vector<double> data;
+      executor.read("THREAD_2/DATA_5", data).get();
+      REQUIRE(data.size() == 16);
+      REQUIRE(std::abs(data[0] - 205.0) < 1e-12);
+      auto value = executor.read<std::vector<double>>("THREAD_3/DATA_9").get();
+      REQUIRE(std::abs(value[15] - 309.0) < 1e-12);
+      auto exists = executor.submit([](green::h5pp::archive& ar) { return ar.is_data("THREAD_0/DATA_0"); }).get();
+      REQUIRE(exists);
+    }
+    green::h5pp::archive ar(filename, "r");
+    std::vector<double>  data;
+    ar["THREAD_1/DATA_1"] >> data;
+    REQUIRE(std::abs(data[0] - 101.0) < 1e-12);
+    ar.close();
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+
+  SECTION("Exceptions") {
+    std::string              root = TEST_PATH;
+    green::h5pp::io_executor executor(root + "/test.h5", "r");
+    double                   x    = 0;
+    auto                     f    = executor.write("GROUP/SCALAR_DATASET", 1.0);
+    REQUIRE_THROWS_AS(f.get(), green::h5pp::hdf5_write_error);
+    REQUIRE_THROWS_AS(executor.read("GROUP/NOT_A_DATASET", x).get(), green::h5pp::hdf5_wrong_path_error);
+    executor.read("GROUP/SCALAR_DATASET", x);
+    executor.wait();
+    REQUIRE(std::abs(x - 1.0) < 1e-12);
+  }
+
+  SECTION("Slab Prefetcher") {
+    std::string filename = TEST_PATH + "/"s + random_name();
+    {
+      green::h5pp::archive ar(filename, "w");
+      for (int k = 0; k < 7; ++k) {
+        std::vector<double> slab(6);
+        std::iota(slab.begin(), slab.end(), k * 6.0);
+        ar["DATA"].append(slab);
+      }
+      ar["STRINGS"] << std::vector<std::string>{"a", "b"};
+    }
+    {
+      green::h5pp::io_executor              executor(filename, "r");
+      green::h5pp::slab_prefetcher<double> prefetcher(executor, "DATA", 2);
+      REQUIRE(prefetcher.size() == 7);
+      REQUIRE(prefetcher.slab_shape() == std::vector<size_t>{6});
+      size_t k = 0;
+      while (prefetcher.has_next()) {
+        auto slab = prefetcher.next();
+        REQUIRE(slab.size() == 6);
+        REQUIRE(std::abs(slab[0] - k * 6.0) < 1e-12);
+        REQUIRE(std::abs(slab[5] - k * 6.0 - 5.0) < 1e-12);
+        ++k;
+      }
+      REQUIRE(k == 7);
+      REQUIRE_THROWS_AS(prefetcher.next(), green::h5pp::hdf5_read_error);
+      green::h5pp::slab_prefetcher<double> column_prefetcher(executor, "DATA", 3, 1);
+      REQUIRE(column_prefetcher.size() == 6);
+      auto column = column_prefetcher.next();
+      column      = column_prefetcher.next();
+      REQUIRE(column.shape() == std::vector<size_t>{7});
+      REQUIRE(std::abs(column[3] - 19.0) < 1e-12);
+      REQUIRE_THROWS_AS(green::h5pp::slab_prefetcher<double>(executor, "DATA", 1, 2), green::h5pp::hdf5_read_error);
+      // read errors are reported for every failed slab and iteration can be continued
+      green::h5pp::slab_prefetcher<double> string_prefetcher(executor, "STRINGS", 1);
+      REQUIRE_THROWS_AS(string_prefetcher.next(), green::h5pp::hdf5_data_conversion_error);
+      REQUIRE_THROWS_AS(string_prefetcher.next(), green::h5pp::hdf5_data_conversion_error);
+      REQUIRE_FALSE(string_prefetcher.has_next());
+    }
+    std::filesystem::remove(std::filesystem::path(filename));
+  }
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+
+#include <catch2/catch_session.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "green/h5pp/archive.h"
+#include "green/h5pp/shared.h"
+
+using namespace std::literals;
+
+TEST_CASE("Shared") {
+  SECTION("Node-Shared Read") {
+    std::string          filename = TEST_PATH + "/test.h5"s;
+    green::h5pp::archive ar(filename, "r");
+    int                  rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    auto dataset = ar["GROUP/NDARRAY_DATASET"];
+    auto shared  = green::h5pp::read_shared<double>(dataset, MPI_COMM_WORLD);
+    int  node_rank;
+    MPI_Comm_rank(shared.node_comm(), &node_rank);
+    // only the node leader opens the dataset
+    REQUIRE(H5Fget_obj_count(ar.file_id(), H5F_OBJ_DATASET) == (node_rank == 0 ? 1 : 0));
+    std::vector<double> data;
+    dataset >> data;
+    REQUIRE(shared.size() == data.size());
+    REQUIRE(shared.shape() == green::h5pp::dataset_shape(ar.current_id(), "GROUP/NDARRAY_DATASET"));
+    REQUIRE(std::equal(data.begin(), data.end(), shared.begin()));
+    auto scalar = green::h5pp::read_shared<double>(ar["GROUP/SCALAR_DATASET"], MPI_COMM_WORLD);
+    REQUIRE(scalar.size() == 1);
+    REQUIRE(std::abs(scalar[0] - 1.0) < 1e-12);
+    REQUIRE_THROWS(green::h5pp::read_shared<double>(ar["GROUP"], MPI_COMM_WORLD));
+  }
+}
+
+int main(int argc, char* argv[]) {
+  MPI_Init(&argc, &argv);
+  int result = Catch::Session().run(argc, argv);
+  MPI_Finalize();
+  return result;
+}
@@ -6,6 +6,8 @@
 #include "green/h5pp/utils.h"
 
 #include <catch2/catch_test_macros.hpp>
+#include <string_view>
+#include <vector>
 
 TEST_CASE("Utils") {
   SECTION("Test Trim") {
@@ -26,4 +28,29 @@ TEST_CASE("Utils") {
     REQUIRE(test.size() == 1);
     REQUIRE(test[0] == "aaa");
   }
+
+  SECTION("Test Tokenize") {
+    std::vector<std::string_view> tokens;
+    std::string                   path = "/aaa/bbb//ccc/ddd/";
+    green::h5pp::utils::for_each_token(path, '/', [&](std::string_view token) { tokens.push_back(token); });
+    REQUIRE(tokens == std::vector<std::string_view>{"aaa", "bbb", "ccc", "ddd"});
+    REQUIRE(tokens[1].data() == path.data() + 5);
+    tokens.clear();
+    green::h5pp::utils::for_each_token("", '/', [&](std::string_view token) { tokens.push_back(token); });
+    REQUIRE(tokens.empty());
+    REQUIRE(green::h5pp::utils::join_path("/aaa", "bbb") == "/aaa/bbb");
+  }
+
+  SECTION("Test Path Builder") {
+    green::h5pp::utils::path_builder builder;
+    REQUIRE(builder.empty());
+    builder.append("aaa").append("bbb");
+    REQUIRE(builder.str() == "/aaa/bbb");
+    REQUIRE(std::string(builder.c_str()) == "/aaa/bbb");
+    const char* buffer = builder.c_str();
+    builder.clear().append("ccc");
+    REQUIRE(builder.str() == "/ccc");
+    // memory is reused
+    REQUIRE(builder.c_str() == buffer);
+  }
 }